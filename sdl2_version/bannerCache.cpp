@@ -0,0 +1,403 @@
+#include "bannerCache.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <limits.h>
+
+// 缓存文件格式：
+//   文件头：magic(8) + version(u32) + count(u32)
+//   每条记录：keyLen(u16) + key + mtime(i64) + size(u64) + gameCode(4) + version(u16)
+//             + icon(4096) + titles(2048) + hasAnimation(u8) [+ animation(4480)]
+static const char CACHE_MAGIC[8] = {'T', 'W', 'L', 'B', 'N', 'R', 'C', 0};
+static const uint32_t CACHE_VERSION = 3;
+
+// 内存中最多保留的、已保存到文件的完整条目数（每项约6KB，动画图标约11KB）
+static const size_t MAX_RESIDENT = 256;
+// gameCode + version + icon + titles（之后是hasAnimation和可选的动画数据）
+static const long RECORD_FIXED_SIZE = 4 + 2 + sizeof(BannerCacheEntry::icon) + sizeof(BannerCacheEntry::titles);
+
+std::string BannerCache::cachePath = "bannercache.bin";
+std::map<std::string, BannerCache::IndexEntry> BannerCache::index;
+std::map<std::string, BannerCacheEntry> BannerCache::entries;
+std::deque<std::string> BannerCache::residentOrder;
+FILE* BannerCache::file = nullptr;
+bool BannerCache::loaded = false;
+bool BannerCache::dirty = false;
+std::mutex BannerCache::mutex;
+
+void BannerCache::init(const std::string& cacheFile) {
+    std::lock_guard<std::mutex> lock(mutex);
+    closeFile();
+    cachePath = cacheFile;
+    index.clear();
+    entries.clear();
+    residentOrder.clear();
+    loaded = false;
+    dirty = false;
+}
+
+void BannerCache::cleanup() {
+    save();
+    std::lock_guard<std::mutex> lock(mutex);
+    closeFile();
+    index.clear();
+    entries.clear();
+    residentOrder.clear();
+    loaded = false;
+}
+
+void BannerCache::closeFile() {
+    if (file) {
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+void BannerCache::load() {
+    loaded = true;
+
+    FILE* fp = fopen(cachePath.c_str(), "rb");
+    if (!fp) {
+        return;  // 还没有缓存文件
+    }
+
+    char magic[8];
+    uint32_t version = 0;
+    uint32_t count = 0;
+    if (fread(magic, sizeof(magic), 1, fp) != 1 ||
+        memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 ||
+        fread(&version, 4, 1, fp) != 1 || version != CACHE_VERSION ||
+        fread(&count, 4, 1, fp) != 1) {
+        std::cerr << "Banner缓存格式无效，忽略: " << cachePath << std::endl;
+        fclose(fp);
+        return;
+    }
+
+    // 只读取键、修改时间和大小，跳过图标和标题，记录的其余部分在用到时再读
+    std::string key;
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t keyLen = 0;
+        if (fread(&keyLen, 2, 1, fp) != 1) break;
+        key.resize(keyLen);
+        if (keyLen > 0 && fread(&key[0], keyLen, 1, fp) != 1) break;
+
+        IndexEntry item;
+        if (fread(&item.mtime, 8, 1, fp) != 1) break;
+        if (fread(&item.size, 8, 1, fp) != 1) break;
+        item.offset = ftell(fp);
+        item.seen = false;
+
+        uint8_t hasAnimation = 0;
+        if (fseek(fp, RECORD_FIXED_SIZE, SEEK_CUR) != 0) break;
+        if (fread(&hasAnimation, 1, 1, fp) != 1) break;
+        if (hasAnimation && fseek(fp, sizeof(NDSBannerAnimation), SEEK_CUR) != 0) break;
+
+        index[key] = item;
+    }
+
+    // 保持文件打开，按需读取记录
+    file = fp;
+    std::cout << "已加载Banner缓存索引: " << index.size() << " 项" << std::endl;
+}
+
+bool BannerCache::readRecord(FILE* fp, long offset, BannerCacheEntry& entry) {
+    if (!fp || offset < 0 || fseek(fp, offset, SEEK_SET) != 0) {
+        return false;
+    }
+    if (fread(entry.gameCode, 4, 1, fp) != 1 ||
+        fread(&entry.version, 2, 1, fp) != 1 ||
+        fread(entry.icon, sizeof(entry.icon), 1, fp) != 1 ||
+        fread(entry.titles, sizeof(entry.titles), 1, fp) != 1) {
+        return false;
+    }
+
+    uint8_t hasAnimation = 0;
+    if (fread(&hasAnimation, 1, 1, fp) != 1) {
+        return false;
+    }
+    entry.animation.reset();
+    if (hasAnimation) {
+        std::shared_ptr<NDSBannerAnimation> animation = std::make_shared<NDSBannerAnimation>();
+        if (fread(animation.get(), sizeof(NDSBannerAnimation), 1, fp) != 1) {
+            return false;
+        }
+        entry.animation = animation;
+    }
+    return true;
+}
+
+bool BannerCache::writeRecord(FILE* fp, const std::string& key, const BannerCacheEntry& entry, long& offset) {
+    uint16_t keyLen = key.size();
+    if (fwrite(&keyLen, 2, 1, fp) != 1 ||
+        fwrite(key.data(), 1, keyLen, fp) != keyLen ||
+        fwrite(&entry.mtime, 8, 1, fp) != 1 ||
+        fwrite(&entry.size, 8, 1, fp) != 1) {
+        return false;
+    }
+    offset = ftell(fp);
+    bool ok = fwrite(entry.gameCode, 4, 1, fp) == 1 &&
+              fwrite(&entry.version, 2, 1, fp) == 1 &&
+              fwrite(entry.icon, sizeof(entry.icon), 1, fp) == 1 &&
+              fwrite(entry.titles, sizeof(entry.titles), 1, fp) == 1;
+
+    uint8_t hasAnimation = entry.animation ? 1 : 0;
+    ok = ok && fwrite(&hasAnimation, 1, 1, fp) == 1;
+    if (ok && hasAnimation) {
+        ok = fwrite(entry.animation.get(), sizeof(NDSBannerAnimation), 1, fp) == 1;
+    }
+    return ok;
+}
+
+bool BannerCache::save(bool pruneMissing) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // 懒验证只覆盖还会被查找的条目：删除、改名或移动了的ROM的记录在这里删除，否则缓存文件会一直增长
+    size_t pruned = 0;
+    if (pruneMissing) {
+        for (auto it = index.begin(); it != index.end();) {
+            int64_t mtime;
+            uint64_t size;
+            if (!it->second.seen &&
+                (!statFile(it->first, mtime, size) || mtime != it->second.mtime || size != it->second.size)) {
+                entries.erase(it->first);
+                it = index.erase(it);
+                pruned++;
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (pruned > 0) {
+        std::cout << "Banner缓存删除 " << pruned << " 个已不存在或已改变的ROM" << std::endl;
+    } else if (!dirty) {
+        return true;
+    }
+
+    // 先写入临时文件再重命名，避免中途退出导致缓存损坏
+    std::string tmpPath = cachePath + ".tmp";
+    FILE* fp = fopen(tmpPath.c_str(), "wb");
+    if (!fp) {
+        std::cerr << "无法写入Banner缓存: " << tmpPath << std::endl;
+        return false;
+    }
+
+    uint32_t count = index.size();
+    bool ok = fwrite(CACHE_MAGIC, sizeof(CACHE_MAGIC), 1, fp) == 1 &&
+              fwrite(&CACHE_VERSION, 4, 1, fp) == 1 &&
+              fwrite(&count, 4, 1, fp) == 1;
+
+    // 不在内存中的条目从旧文件逐条复制；新位置在重命名成功后才生效
+    std::map<std::string, long> offsets;
+    BannerCacheEntry copy;
+    for (const auto& pair : index) {
+        if (!ok) break;
+        const BannerCacheEntry* entry;
+        auto it = entries.find(pair.first);
+        if (it != entries.end()) {
+            entry = &it->second;
+        } else {
+            copy.mtime = pair.second.mtime;
+            copy.size = pair.second.size;
+            ok = readRecord(file, pair.second.offset, copy);
+            entry = &copy;
+        }
+        ok = ok && writeRecord(fp, pair.first, *entry, offsets[pair.first]);
+    }
+
+    if (fclose(fp) != 0) ok = false;
+    if (!ok || rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+        std::cerr << "保存Banner缓存失败: " << cachePath << std::endl;
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    // 改为读取新文件；刚保存的条目以后可以从内存中淘汰
+    closeFile();
+    file = fopen(cachePath.c_str(), "rb");
+    for (auto& pair : index) {
+        if (pair.second.offset < 0) {
+            residentOrder.push_back(pair.first);
+        }
+        pair.second.offset = file ? offsets[pair.first] : -1;
+    }
+    dirty = false;
+    evictResident();
+    return true;
+}
+
+void BannerCache::evictResident() {
+    while (residentOrder.size() > MAX_RESIDENT) {
+        auto it = index.find(residentOrder.front());
+        // 未保存的条目必须留在内存中
+        if (it == index.end() || it->second.offset >= 0) {
+            entries.erase(residentOrder.front());
+        }
+        residentOrder.pop_front();
+    }
+}
+
+void BannerCache::trim() {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t before = entries.size();
+    for (auto it = entries.begin(); it != entries.end();) {
+        auto item = index.find(it->first);
+        if (item != index.end() && item->second.offset >= 0) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    residentOrder.clear();
+    if (before != entries.size()) {
+        std::cout << "Banner缓存释放 " << before - entries.size() << " 项" << std::endl;
+    }
+}
+
+bool BannerCache::statFile(const std::string& filePath, int64_t& mtime, uint64_t& size) {
+    struct stat st;
+    if (stat(filePath.c_str(), &st) != 0) {
+        return false;
+    }
+    mtime = (int64_t)st.st_mtime;
+    size = (uint64_t)st.st_size;
+    return true;
+}
+
+static std::string currentDirectory() {
+    char buf[PATH_MAX];
+    return getcwd(buf, sizeof(buf)) ? buf : "/";
+}
+
+std::string BannerCache::makeKey(const std::string& filePath) {
+    // 局部静态变量的初始化是线程安全的
+    static const std::string cwd = currentDirectory();
+
+    std::string full = (!filePath.empty() && filePath[0] == '/') ? filePath : cwd + "/" + filePath;
+
+    // 规范化：去掉 "."、空段，处理 ".."
+    std::vector<std::string> parts;
+    size_t start = 0;
+    while (start <= full.size()) {
+        size_t end = full.find('/', start);
+        if (end == std::string::npos) end = full.size();
+        std::string part = full.substr(start, end - start);
+        if (part == "..") {
+            if (!parts.empty()) parts.pop_back();
+        } else if (!part.empty() && part != ".") {
+            parts.push_back(part);
+        }
+        start = end + 1;
+    }
+
+    std::string key;
+    for (const auto& part : parts) {
+        key += "/" + part;
+    }
+    return key.empty() ? "/" : key;
+}
+
+const BannerCacheEntry* BannerCache::lookup(const std::string& filePath) {
+    // 懒验证：ROM被替换或修改后缓存失效（与索引中的修改时间和大小比较，不必先读记录）
+    int64_t mtime;
+    uint64_t size;
+    if (!statFile(filePath, mtime, size)) {
+        return nullptr;
+    }
+
+    const BannerCacheEntry* cached = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!loaded) load();
+
+        std::string key = makeKey(filePath);
+        auto item = index.find(key);
+        if (item == index.end() || item->second.mtime != mtime || item->second.size != size) {
+            return nullptr;
+        }
+        item->second.seen = true;
+
+        auto it = entries.find(key);
+        if (it == entries.end()) {
+            BannerCacheEntry entry;
+            entry.mtime = mtime;
+            entry.size = size;
+            if (!readRecord(file, item->second.offset, entry)) {
+                std::cerr << "读取Banner缓存记录失败: " << key << std::endl;
+                return nullptr;
+            }
+            it = entries.emplace(key, entry).first;
+            residentOrder.push_back(key);
+            evictResident();
+        }
+        // （条目只在主线程写入和淘汰，解锁后主线程读取仍然安全）
+        cached = &it->second;
+    }
+    return cached;
+}
+
+bool BannerCache::lookupCopy(const std::string& filePath, BannerCacheEntry& entry) {
+    int64_t mtime;
+    uint64_t size;
+    if (!statFile(filePath, mtime, size)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!loaded) load();
+
+    std::string key = makeKey(filePath);
+    auto item = index.find(key);
+    if (item == index.end() || item->second.mtime != mtime || item->second.size != size) {
+        return false;
+    }
+    item->second.seen = true;
+
+    // 工作线程不改变内存中的条目（主线程可能持有lookup返回的指针），直接复制或从文件读取
+    auto it = entries.find(key);
+    if (it != entries.end()) {
+        entry = it->second;
+        return true;
+    }
+    entry.mtime = mtime;
+    entry.size = size;
+    return readRecord(file, item->second.offset, entry);
+}
+
+bool BannerCache::buildEntry(const std::string& filePath, BannerCacheEntry& entry) {
+    if (!statFile(filePath, entry.mtime, entry.size)) {
+        return false;
+    }
+
+    // 一次读取解析Banner（图标和标题共用同一份记录）
+    NDSBannerInfo info;
+    if (!readNDSBannerInfo(filePath, info)) {
+        return false;
+    }
+
+    // 解码图标并保存全部标题
+    memcpy(entry.gameCode, info.gameCode, sizeof(entry.gameCode));
+    entry.version = info.version;
+    decodeNDSIcon(info.icon, info.palette, entry.icon);
+    memcpy(entry.titles, info.titles, sizeof(entry.titles));
+    entry.animation = std::move(info.animation);
+    return true;
+}
+
+const BannerCacheEntry* BannerCache::store(const std::string& filePath, const BannerCacheEntry& entry) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!loaded) load();
+
+    std::string key = makeKey(filePath);
+    IndexEntry& item = index[key];
+    item.mtime = entry.mtime;
+    item.size = entry.size;
+    item.offset = -1;   // 保存前只在内存中
+    item.seen = true;
+    BannerCacheEntry& stored = entries[key];
+    stored = entry;
+    dirty = true;
+    return &stored;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <cstdint>
+#include <mutex>
+#include <memory>
+#include <deque>
+#include <cstdio>
+#include "ndsBanner.h"
+
+// 持久化Banner缓存条目（解码后的图标和全部标题）
+struct BannerCacheEntry {
+    int64_t mtime;              // ROM文件修改时间
+    uint64_t size;              // ROM文件大小
+    char gameCode[4];           // 游戏代码
+    uint16_t version;           // Banner版本
+    uint32_t icon[32 * 32];     // 解码后的32x32 RGBA图标
+    uint16_t titles[8][128];    // 8种语言的标题（UTF-16）
+    std::shared_ptr<const NDSBannerAnimation> animation;  // DSi动画原始数据（没有时为空，创建后只读）
+};
+
+// Banner磁盘缓存：以 路径+修改时间+大小 为键，避免每次启动重新读取ROM
+// 内存中只保存索引（键、修改时间、大小和记录在文件中的位置），完整条目按需从文件读取，
+// 只保留未保存的新条目和最近读取的少量条目
+// 写入只在主线程进行，工作线程通过lookupCopy读取
+class BannerCache {
+public:
+    static void init(const std::string& cacheFile = "bannercache.bin");
+    static void cleanup();
+
+    // 查找缓存（懒验证：比较文件当前的修改时间和大小），未命中或已过期返回nullptr
+    // 返回的条目在下一次lookup/store/trim之前有效（只在主线程调用）
+    static const BannerCacheEntry* lookup(const std::string& filePath);
+
+    // 线程安全的查找，命中时复制条目（供工作线程使用）
+    static bool lookupCopy(const std::string& filePath, BannerCacheEntry& entry);
+
+    // 读取ROM的Banner并生成缓存条目（不写入缓存，可在任意线程调用）
+    static bool buildEntry(const std::string& filePath, BannerCacheEntry& entry);
+
+    // 写入缓存（entry中的mtime/size应来自statFile），返回缓存中的条目
+    static const BannerCacheEntry* store(const std::string& filePath, const BannerCacheEntry& entry);
+
+    // 保存到磁盘（仅在有修改时写入）
+    // pruneMissing：删除本次没有查找到、ROM文件已不存在或已改变的条目（ROM被删除、改名或移动后旧记录不会再被使用）；
+    // 缓存键不是本机路径时（twl_scan -p）不能用文件状态判断，应传入false
+    static bool save(bool pruneMissing = true);
+
+    // 释放内存中已保存到文件的完整条目，只保留索引（内存紧张时调用，只在主线程调用）
+    static void trim();
+
+    // 获取文件的修改时间和大小
+    static bool statFile(const std::string& filePath, int64_t& mtime, uint64_t& size);
+
+    // 生成缓存键（规范化的绝对路径，保证UI和扫描工具使用相同的键）
+    static std::string makeKey(const std::string& filePath);
+
+private:
+    // 索引项：offset为记录中gameCode在缓存文件中的位置，-1表示只在内存中（还没有保存）
+    struct IndexEntry {
+        int64_t mtime;
+        uint64_t size;
+        long offset;
+        bool seen;      // 本次运行中查找命中或写入过（保存时不需要检查文件是否还存在）
+    };
+
+    static std::string cachePath;
+    static std::map<std::string, IndexEntry> index;
+    static std::map<std::string, BannerCacheEntry> entries;   // 内存中的完整条目
+    static std::deque<std::string> residentOrder;             // 从文件读入的条目，按读入顺序淘汰
+    static FILE* file;                                        // 打开的缓存文件（按需读取记录）
+    static bool loaded;
+    static bool dirty;
+    static std::mutex mutex;
+
+    static void load();
+    static void closeFile();
+    static bool readRecord(FILE* fp, long offset, BannerCacheEntry& entry);
+    static bool writeRecord(FILE* fp, const std::string& key, const BannerCacheEntry& entry, long& offset);
+    static void evictResident();
+};
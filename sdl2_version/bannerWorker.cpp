@@ -0,0 +1,113 @@
+#include "bannerWorker.h"
+
+std::vector<std::thread> BannerWorkerPool::workers;
+std::deque<std::string> BannerWorkerPool::jobs;
+std::mutex BannerWorkerPool::jobMutex;
+std::condition_variable BannerWorkerPool::jobCondition;
+std::atomic<BannerJobResult*> BannerWorkerPool::completed(nullptr);
+std::atomic<bool> BannerWorkerPool::stopping(false);
+
+void BannerWorkerPool::init(int threadCount) {
+    if (!workers.empty()) return;
+
+    stopping = false;
+    if (threadCount < 1) threadCount = 1;
+    for (int i = 0; i < threadCount; i++) {
+        workers.emplace_back(workerMain);
+    }
+}
+
+void BannerWorkerPool::cleanup() {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobCondition.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+
+    // 释放未被取走的结果
+    BannerJobResult* result = takeCompleted();
+    while (result) {
+        BannerJobResult* next = result->next;
+        delete result;
+        result = next;
+    }
+}
+
+void BannerWorkerPool::request(const std::string& filePath) {
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        jobs.push_back(filePath);
+    }
+    jobCondition.notify_one();
+}
+
+void BannerWorkerPool::dropQueued(std::vector<std::string>& dropped) {
+    std::lock_guard<std::mutex> lock(jobMutex);
+    dropped.insert(dropped.end(), jobs.begin(), jobs.end());
+    jobs.clear();
+}
+
+void BannerWorkerPool::pushCompleted(BannerJobResult* result) {
+    // 无锁压栈（多个工作线程生产，主线程一次性取走）
+    result->next = completed.load(std::memory_order_relaxed);
+    while (!completed.compare_exchange_weak(result->next, result,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+    }
+}
+
+BannerJobResult* BannerWorkerPool::takeCompleted() {
+    BannerJobResult* list = completed.exchange(nullptr, std::memory_order_acquire);
+
+    // 栈是后进先出，反转为完成顺序
+    BannerJobResult* ordered = nullptr;
+    while (list) {
+        BannerJobResult* next = list->next;
+        list->next = ordered;
+        ordered = list;
+        list = next;
+    }
+    return ordered;
+}
+
+void BannerWorkerPool::workerMain() {
+    while (true) {
+        std::string filePath;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobCondition.wait(lock, [] { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            // 后进先出：翻页时优先处理当前可见的图标
+            filePath = jobs.back();
+            jobs.pop_back();
+        }
+
+        BannerJobResult* result = new BannerJobResult();
+        result->filePath = filePath;
+        result->ok = false;
+        result->fromCache = false;
+        result->next = nullptr;
+
+        if (BannerCache::lookupCopy(filePath, result->entry)) {
+            result->ok = true;
+            result->fromCache = true;
+        } else if (BannerCache::buildEntry(filePath, result->entry)) {
+            result->ok = true;
+        }
+
+        // DSi动画：在工作线程中编译序列并解码全部帧，主线程只需上传
+        if (result->ok && result->entry.animation &&
+            compileNDSIconAnimation(*result->entry.animation, result->animation)) {
+            result->animationPixels.resize(result->animation.images.size() * 32 * 32);
+            decodeNDSIconAnimation(*result->entry.animation, result->animation, result->animationPixels.data());
+        }
+
+        pushCompleted(result);
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "bannerCache.h"
+
+// 后台解析结果
+struct BannerJobResult {
+    std::string filePath;
+    bool ok;                  // 是否成功读取
+    bool fromCache;           // 是否来自磁盘缓存（无需再次写入）
+    BannerCacheEntry entry;   // 解码后的图标和标题
+    NDSIconAnimation animation;          // 编译后的DSi动画序列（steps为空表示没有动画）
+    std::vector<uint32_t> animationPixels;  // 动画用到的图像（每张32x32，依次存放）
+    BannerJobResult* next;    // 完成队列链表指针
+};
+
+// Banner后台解析线程池：在工作线程中读取并解码Banner，
+// 结果通过无锁完成队列交给主线程上传纹理
+class BannerWorkerPool {
+public:
+    static void init(int threadCount = 2);
+    static void cleanup();
+
+    // 投递解析任务（主线程调用，最新的任务优先处理）
+    static void request(const std::string& filePath);
+
+    // 丢弃尚未开始的任务（主线程调用），被丢弃的路径追加到dropped；正在处理的任务照常完成
+    static void dropQueued(std::vector<std::string>& dropped);
+
+    // 取出所有已完成的结果（主线程调用，按完成顺序排列的链表，调用者负责delete）
+    static BannerJobResult* takeCompleted();
+
+private:
+    static std::vector<std::thread> workers;
+    static std::deque<std::string> jobs;
+    static std::mutex jobMutex;
+    static std::condition_variable jobCondition;
+    static std::atomic<BannerJobResult*> completed;
+    static std::atomic<bool> stopping;
+
+    static void workerMain();
+    static void pushCompleted(BannerJobResult* result);
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 缓存统计（用于调整内存预算）
+struct CacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t bytesUsed;
+    size_t budgetBytes;
+
+    CacheStats() : hits(0), misses(0), evictions(0), bytesUsed(0), budgetBytes(0) {}
+};
@@ -0,0 +1,35 @@
+#include "collation.h"
+
+std::string makeCollationKey(const std::string& text) {
+    std::string key;
+    key.reserve(text.size() + 4);
+
+    size_t i = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        if (c >= '0' && c <= '9') {
+            // 数字串：去掉前导零后写入 '0' + 位数 + 数字，位数少的数值更小
+            size_t end = i;
+            while (end < text.size() && text[end] >= '0' && text[end] <= '9') {
+                end++;
+            }
+            size_t start = i;
+            while (start + 1 < end && text[start] == '0') {
+                start++;
+            }
+            size_t digits = end - start;
+            key += '0';
+            key += (char)(digits < 255 ? digits : 255);
+            key.append(text, start, digits);
+            i = end;
+            continue;
+        }
+
+        if (c >= 'A' && c <= 'Z') {
+            c = c - 'A' + 'a';
+        }
+        key += c;
+        i++;
+    }
+    return key;
+}
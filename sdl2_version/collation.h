@@ -0,0 +1,7 @@
+#pragma once
+
+#include <string>
+
+// 生成文件名/标题的排序键：ASCII字母忽略大小写，连续的数字按数值比较
+// （"Game 2"排在"Game 10"之前）。排序键之间直接按字节比较，排序时不再做任何转换
+std::string makeCollationKey(const std::string& text);
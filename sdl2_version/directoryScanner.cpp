@@ -0,0 +1,121 @@
+#include "directoryScanner.h"
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+// 每批最多的条目数，以及两次提交之间的最长间隔（保证第一屏尽快显示）
+static const size_t BATCH_SIZE = 32;
+static const int BATCH_INTERVAL_MS = 10;
+
+DirectoryScanner::DirectoryScanner() : cancelRequested(false), scanning(false), finished(true) {
+}
+
+DirectoryScanner::~DirectoryScanner() {
+    cancel();
+}
+
+void DirectoryScanner::start(const std::string& dirPath, TypeFilter filter) {
+    cancel();
+
+    {
+        std::lock_guard<std::mutex> lock(batchMutex);
+        pending.clear();
+        finished = false;
+    }
+    cancelRequested = false;
+    scanning = true;
+    worker = std::thread(&DirectoryScanner::scan, this, dirPath, filter);
+}
+
+void DirectoryScanner::cancel() {
+    cancelRequested = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    scanning = false;
+
+    std::lock_guard<std::mutex> lock(batchMutex);
+    pending.clear();
+    finished = true;
+}
+
+bool DirectoryScanner::takeBatch(FileListing& entries) {
+    std::lock_guard<std::mutex> lock(batchMutex);
+    if (entries.empty()) {
+        std::swap(entries, pending);
+    } else {
+        entries.append(pending, 0);
+    }
+    pending.clear();
+    if (finished && scanning) {
+        scanning = false;
+        return true;
+    }
+    return false;
+}
+
+void DirectoryScanner::publish(FileListing& batch, bool done) {
+    std::lock_guard<std::mutex> lock(batchMutex);
+    if (pending.empty()) {
+        std::swap(pending, batch);
+    } else {
+        pending.append(batch, 0);
+    }
+    batch.clear();
+    finished = done;
+}
+
+void DirectoryScanner::scan(std::string dirPath, TypeFilter filter) {
+    FileListing batch;
+
+    DIR* dir = opendir(dirPath.c_str());
+    if (!dir) {
+        // 如果无法打开目录，添加错误信息
+        batch.addEntry(0, "[无法打开目录]", 0, FILE_TYPE_OTHER);
+        publish(batch, true);
+        return;
+    }
+    int dirFd = dirfd(dir);
+
+    auto lastPublish = std::chrono::steady_clock::now();
+    struct dirent* entry;
+    while (!cancelRequested && (entry = readdir(dir)) != nullptr) {
+        // 跳过 "." 目录
+        if (strcmp(entry->d_name, ".") == 0) {
+            continue;
+        }
+
+        // 优先使用d_type，文件系统不提供类型（或是符号链接）时才对目录fd做fstatat
+        bool isDirectory;
+        if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+            struct stat st;
+            if (fstatat(dirFd, entry->d_name, &st, 0) != 0) {
+                continue;
+            }
+            isDirectory = S_ISDIR(st.st_mode);
+        } else {
+            isDirectory = (entry->d_type == DT_DIR);
+        }
+
+        // 文件类型只在这里判断一次；文件根据过滤模式决定是否显示
+        FileType type = isDirectory ? FILE_TYPE_DIRECTORY : classifyFileName(entry->d_name);
+        if (!isDirectory && filter && !filter(type)) {
+            continue;
+        }
+
+        // 标题和大小在条目可见时才读取，先显示文件名；排序键在这里计算
+        batch.addEntry(0, entry->d_name, isDirectory ? FILE_ENTRY_DIRECTORY : FILE_ENTRY_METADATA_PENDING, type);
+
+        auto now = std::chrono::steady_clock::now();
+        if (batch.size() >= BATCH_SIZE ||
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - lastPublish).count() >= BATCH_INTERVAL_MS) {
+            publish(batch, false);
+            lastPublish = now;
+        }
+    }
+
+    closedir(dir);
+    publish(batch, true);
+}
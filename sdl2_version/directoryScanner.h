@@ -0,0 +1,44 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include "fileListing.h"
+
+// 后台目录扫描：在工作线程中枚举目录，按批次把条目交给主线程，
+// 用户离开目录时可以随时取消
+class DirectoryScanner {
+public:
+    // 按文件类型过滤（在工作线程中调用，必须是纯函数）
+    typedef std::function<bool(FileType type)> TypeFilter;
+
+    DirectoryScanner();
+    ~DirectoryScanner();
+
+    // 开始扫描（先取消正在进行的扫描）
+    void start(const std::string& dirPath, TypeFilter filter);
+
+    // 取消扫描并等待工作线程退出
+    void cancel();
+
+    // 取出已扫描的条目（主线程调用），扫描已全部完成时返回true
+    // 条目的目录下标为0（扫描的目录）
+    bool takeBatch(FileListing& entries);
+
+    bool isScanning() const { return scanning; }
+
+private:
+    std::thread worker;
+    std::atomic<bool> cancelRequested;
+    bool scanning;                       // 仅主线程访问
+
+    std::mutex batchMutex;
+    FileListing pending;                 // 已扫描、尚未取走的条目
+    bool finished;                       // 受batchMutex保护
+
+    void scan(std::string dirPath, TypeFilter filter);
+    void publish(FileListing& batch, bool done);
+};
@@ -0,0 +1,61 @@
+#include "dirtyTracker.h"
+#include "gameGrid.h"
+#include <iostream>
+#include <algorithm>
+
+UIState DirtyTracker::lastState = {};
+bool DirtyTracker::dirty = true;    // 第一帧总是绘制
+uint32_t DirtyTracker::renderedFrames = 0;
+uint32_t DirtyTracker::skippedFrames = 0;
+const Uint32 DirtyTracker::BATTERY_POLL_MS;
+const Uint32 DirtyTracker::CHARGE_BLINK_MS;
+
+void DirtyTracker::cleanup() {
+    std::cout << "帧统计: 绘制 " << renderedFrames << ", 跳过 " << skippedFrames << std::endl;
+    dirty = true;
+}
+
+void DirtyTracker::invalidate() {
+    dirty = true;
+}
+
+bool DirtyTracker::sameState(const UIState& a, const UIState& b) {
+    return a.selectedIndex == b.selectedIndex &&
+           a.scrollOffset == b.scrollOffset &&
+           a.listTopRow == b.listTopRow &&
+           a.itemCount == b.itemCount &&
+           a.keysHeld == b.keysHeld &&
+           a.menuActive == b.menuActive &&
+           a.browserActive == b.browserActive &&
+           a.libraryMode == b.libraryMode &&
+           a.listView == b.listView &&
+           a.libraryUpdating == b.libraryUpdating &&
+           a.clockMinute == b.clockMinute &&
+           a.batteryLevel == b.batteryLevel &&
+           a.charging == b.charging &&
+           a.chargeBlink == b.chargeBlink;
+}
+
+bool DirtyTracker::shouldRender(const UIState& state, bool inputActive) {
+    if (!dirty && !inputActive && sameState(state, lastState)) {
+        skippedFrames++;
+        return false;
+    }
+    lastState = state;
+    dirty = false;
+    renderedFrames++;
+    return true;
+}
+
+bool DirtyTracker::isGridAnimating(const UIState& state) {
+    return !state.menuActive && !state.browserActive && !state.listView && GameGrid::isAnimating();
+}
+
+Uint32 DirtyTracker::getIdleTimeout(time_t clockTime, bool charging) {
+    Uint32 timeout = (Uint32)(60 - clockTime % 60) * 1000;
+    timeout = std::min(timeout, BATTERY_POLL_MS);
+    if (charging) {
+        timeout = std::min(timeout, CHARGE_BLINK_MS - SDL_GetTicks() % CHARGE_BLINK_MS);
+    }
+    return std::max<Uint32>(timeout, 1);
+}
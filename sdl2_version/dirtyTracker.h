@@ -0,0 +1,60 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <ctime>
+
+// 决定屏幕内容的界面状态（每帧由主循环采集）
+struct UIState {
+    int selectedIndex;      // 网格/列表的选中项
+    int scrollOffset;       // 网格滚动位置
+    int listTopRow;         // 列表视图第一行
+    int itemCount;          // 当前列表条目数
+    uint16_t keysHeld;      // 按住的键（L/R按钮高亮、首字母提示）
+    bool menuActive;        // 主菜单是否显示
+    bool browserActive;     // 文件浏览器是否显示
+    bool libraryMode;
+    bool listView;          // 列表视图显示中（ROM库模式总是显示网格）
+    bool libraryUpdating;   // ROM库索引后台更新中（搜索栏显示"..."）
+    int64_t clockMinute;    // 时钟显示的分钟
+    int batteryLevel;       // 电池图标等级（0-4）
+    bool charging;
+    int chargeBlink;        // 充电图标的闪烁相位
+};
+
+// 重绘跟踪：界面状态与上一次绘制时相同、也没有其他变化时，主循环跳过绘制和呈现，
+// 阻塞等待下一个输入事件或定时变化（时钟分钟、充电图标闪烁、电池电量）
+class DirtyTracker {
+public:
+    static void cleanup();
+
+    // 下一帧必须重绘：后台读取的图标和标题、目录变化、动画进行中、窗口需要重绘等
+    static void invalidate();
+
+    // 本帧是否需要绘制（inputActive：本帧有按键按下、释放或连发）
+    // 需要绘制时记录新的状态，否则计入跳过的帧
+    static bool shouldRender(const UIState& state, bool inputActive);
+
+    // 网格滚动动画是否需要继续绘制：只在网格是当前视图时计入
+    // （列表视图通过GameGrid::setSelectedIndex移动选中项，但不调用GameGrid::update推进动画）
+    static bool isGridAnimating(const UIState& state);
+
+    // 空闲时等待事件的最长时间（毫秒）：到下一次时钟分钟变化、充电图标闪烁或读取电池电量
+    static Uint32 getIdleTimeout(time_t clockTime, bool charging);
+
+    static uint32_t getRenderedFrames() { return renderedFrames; }
+    static uint32_t getSkippedFrames() { return skippedFrames; }
+
+    // 两次读取电池信息之间的间隔
+    static const Uint32 BATTERY_POLL_MS = 5000;
+    // 充电图标的闪烁周期
+    static const Uint32 CHARGE_BLINK_MS = 500;
+
+private:
+    static UIState lastState;
+    static bool dirty;
+    static uint32_t renderedFrames;
+    static uint32_t skippedFrames;
+
+    static bool sameState(const UIState& a, const UIState& b);
+};
@@ -6,6 +6,7 @@
 #include "ndsIconLoader.h"
 #include "settings.h"
 #include "gameGrid.h"
+#include "dirtyTracker.h"
 #include <ctime>
 #include <sstream>
 #include <iomanip>
@@ -26,8 +27,13 @@ SDL_Texture* DSiUI::batteryChargeBlinkTexture = nullptr;
 SDL_Texture* DSiUI::volumeTextures[5] = {nullptr};
 SDL_Texture* DSiUI::folderTexture = nullptr;
 SDL_Texture* DSiUI::ndsFileTexture = nullptr;
+SDL_Texture* DSiUI::fileTypeTextures[FILE_TYPE_COUNT] = {nullptr};
 SDL_Texture* DSiUI::boxEmptyTexture = nullptr;
 SDL_Texture* DSiUI::boxFullTexture = nullptr;
+int DSiUI::batteryLevel = 50;
+bool DSiUI::batteryCharging = false;
+bool DSiUI::batteryValid = false;
+Uint32 DSiUI::batteryReadTime = 0;
 
 void DSiUI::init(SDL_Renderer* renderer) {
     DSiUI::renderer = renderer;
@@ -88,6 +94,12 @@ void DSiUI::loadTextures() {
         ndsFileTexture = ResourceManager::loadImageFromTheme("grf/small_cart");
     }
     
+    // 其他ROM类型的图标（grf/icon_gba等），绘制时按条目中保存的类型直接取用
+    for (int type = 0; type < FILE_TYPE_COUNT; type++) {
+        const char* icon = getFileTypeIcon((FileType)type);
+        fileTypeTextures[type] = icon ? ResourceManager::loadImageFromTheme(icon) : nullptr;
+    }
+    
     std::cout << "Classic DS Menu UI纹理加载完成" << std::endl;
     std::cout << "  上屏背景: " << (topBgTexture ? "✓" : "✗") << std::endl;
     std::cout << "  下屏背景: " << (bottomBgTexture ? "✓" : "✗") << std::endl;
@@ -108,6 +120,9 @@ void DSiUI::freeTextures() {
     batteryChargeBlinkTexture = nullptr;
     folderTexture = nullptr;
     ndsFileTexture = nullptr;
+    for (int type = 0; type < FILE_TYPE_COUNT; type++) {
+        fileTypeTextures[type] = nullptr;
+    }
     boxEmptyTexture = nullptr;
     boxFullTexture = nullptr;
 }
@@ -188,7 +203,7 @@ void DSiUI::drawBatteryIcon(int level, bool charging) {
     if (charging) {
         // 使用闪烁效果：根据时间切换充电图标
         Uint32 ticks = SDL_GetTicks();
-        bool blink = (ticks / 500) % 2 == 0;  // 每500ms切换一次
+        bool blink = (ticks / DirtyTracker::CHARGE_BLINK_MS) % 2 == 0;  // 每500ms切换一次
         
         SDL_Texture* chargeTex = blink ? batteryChargeBlinkTexture : batteryChargeTexture;
         if (chargeTex) {
@@ -230,7 +245,17 @@ void DSiUI::drawBatteryIcon(int level, bool charging) {
     }
 }
 
-int DSiUI::getBatteryLevel() {
+void DSiUI::readBattery() {
+    // 电量变化很慢，不必每帧打开sysfs文件：间隔一段时间才重新读取
+    Uint32 now = SDL_GetTicks();
+    if (batteryValid && now - batteryReadTime < DirtyTracker::BATTERY_POLL_MS) {
+        return;
+    }
+    batteryValid = true;
+    batteryReadTime = now;
+    
+    // 如果无法读取，使用默认值50
+    batteryLevel = 50;
     std::ifstream capacityFile("/sys/class/power_supply/battery/capacity");
     if (capacityFile.is_open()) {
         int capacity = 0;
@@ -239,23 +264,29 @@ int DSiUI::getBatteryLevel() {
         // 确保返回值在0-100之间
         if (capacity < 0) capacity = 0;
         if (capacity > 100) capacity = 100;
-        return capacity;
+        batteryLevel = capacity;
     }
-    // 如果无法读取，返回默认值50
-    return 50;
-}
-
-bool DSiUI::isBatteryCharging() {
+    
+    // 如果无法读取，默认为未充电
+    batteryCharging = false;
     std::ifstream chargeTypeFile("/sys/class/power_supply/battery/charge_type");
     if (chargeTypeFile.is_open()) {
         std::string chargeType;
         chargeTypeFile >> chargeType;
         chargeTypeFile.close();
         // 如果charge_type为"Standard"，表示正在充电
-        return (chargeType == "Standard");
+        batteryCharging = (chargeType == "Standard");
     }
-    // 如果无法读取，默认返回false（未充电）
-    return false;
+}
+
+int DSiUI::getBatteryLevel() {
+    readBattery();
+    return batteryLevel;
+}
+
+bool DSiUI::isBatteryCharging() {
+    readBattery();
+    return batteryCharging;
 }
 
 void DSiUI::drawVolumeIcon(int level) {
@@ -295,25 +326,11 @@ void DSiUI::drawShoulderButtons(bool leftActive, bool rightActive) {
 }
 
 bool DSiUI::isNDSFile(const std::string& filename) {
-    // 转换为小写进行比较
-    std::string lowerName = filename;
-    std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
-    
-    // NDS文件扩展名列表
-    const char* ndsExtensions[] = {".nds", ".dsi", ".ids", ".srl", ".app", ".argv", nullptr};
-    
-    for (int i = 0; ndsExtensions[i] != nullptr; i++) {
-        if (lowerName.length() >= strlen(ndsExtensions[i])) {
-            std::string ext = lowerName.substr(lowerName.length() - strlen(ndsExtensions[i]));
-            if (ext == ndsExtensions[i]) {
-                return true;
-            }
-        }
-    }
-    return false;
+    // 与扫描工具共用同一份扩展名表
+    return classifyFileName(filename.c_str()) == FILE_TYPE_NDS;
 }
 
-void DSiUI::drawGameGrid(int selectedIndex, int scrollOffset, const std::vector<FileEntry>* files) {
+void DSiUI::drawGameGrid(int selectedIndex, int scrollOffset, const FileListing* files) {
     if (!renderer) return;
     
     // DSi风格的游戏图标网格（水平滚动，现在在下屏）
@@ -328,14 +345,8 @@ void DSiUI::drawGameGrid(int selectedIndex, int scrollOffset, const std::vector<
     
     // 绘制选中文件的标题（在菜单上方居中显示）
     if (files && selectedIndex >= 0 && selectedIndex < (int)files->size()) {
-        const FileEntry& selectedEntry = (*files)[selectedIndex];
-        std::string displayName;
         // 优先使用NDS内部标题，如果没有则使用文件名
-        if (!selectedEntry.title.empty()) {
-            displayName = selectedEntry.title;
-        } else if (!selectedEntry.name.empty()) {
-            displayName = selectedEntry.name;
-        }
+        std::string displayName = files->getTitle((*files)[selectedIndex]);
         
         if (!displayName.empty()) {
             // 如果标题太长，截断
@@ -377,13 +388,15 @@ void DSiUI::drawGameGrid(int selectedIndex, int scrollOffset, const std::vector<
         // 确定文件类型
         bool isDirectory = false;
         bool isNDS = false;
+        FileType fileType = FILE_TYPE_OTHER;
         std::string fileName = "";
         
         if (files && pos < (int)files->size()) {
             const FileEntry& entry = (*files)[pos];
-            isDirectory = entry.isDirectory;
-            isNDS = !isDirectory && isNDSFile(entry.name);
-            fileName = entry.name;
+            isDirectory = entry.isDirectory();
+            fileType = (FileType)entry.type;
+            isNDS = fileType == FILE_TYPE_NDS;
+            fileName = files->getName(entry);
         }
         
         bool isSelected = (pos == selectedIndex);
@@ -445,6 +458,9 @@ void DSiUI::drawGameGrid(int selectedIndex, int scrollOffset, const std::vector<
         
         // 绘制图标
         SDL_Texture* iconTex = nullptr;
+        IconHandle iconHandle;
+        const SDL_Rect* iconSrcRect = nullptr;  // 图集中的位置（nullptr表示整张纹理）
+        SDL_RendererFlip iconFlip = SDL_FLIP_NONE;  // DSi动画帧的翻转
         if (isDirectory) {
             // 经典文件夹图标：简洁、清晰
             int iconX = x + 8;
@@ -485,9 +501,10 @@ void DSiUI::drawGameGrid(int selectedIndex, int scrollOffset, const std::vector<
             // 尝试从NDS文件加载实际图标
             if (files && pos < (int)files->size()) {
                 const FileEntry& entry = (*files)[pos];
-                SDL_Texture* ndsIcon = NDSIconLoader::loadIconFromNDS(entry.path);
-                if (ndsIcon) {
-                    iconTex = ndsIcon;
+                if (NDSIconLoader::loadIconFromNDS(files->getPath(entry), iconHandle)) {
+                    iconTex = iconHandle.texture;
+                    iconSrcRect = &iconHandle.rect;
+                    iconFlip = iconHandle.flip;
                 } else if (ndsFileTexture) {
                     // 如果加载失败，使用默认NDS图标
                     iconTex = ndsFileTexture;
@@ -502,6 +519,11 @@ void DSiUI::drawGameGrid(int selectedIndex, int scrollOffset, const std::vector<
                 SDL_Rect ndsRect = {x + 8, y + 8, 32, 32};
                 SDL_RenderFillRect(renderer, &ndsRect);
             }
+        } else if (fileTypeTextures[fileType]) {
+            // 主题图标为32x64（两帧动画）或32x32，只取第一帧
+            static const SDL_Rect firstFrame = {0, 0, 32, 32};
+            iconTex = fileTypeTextures[fileType];
+            iconSrcRect = &firstFrame;
         }
         
         if (iconTex) {
@@ -515,7 +537,11 @@ void DSiUI::drawGameGrid(int selectedIndex, int scrollOffset, const std::vector<
             }
             
             SDL_Rect iconRect = {x + 8, y + 8, 32, 32};
-            SDL_RenderCopy(renderer, iconTex, nullptr, &iconRect);
+            if (iconFlip != SDL_FLIP_NONE) {
+                SDL_RenderCopyEx(renderer, iconTex, iconSrcRect, &iconRect, 0.0, nullptr, iconFlip);
+            } else {
+                SDL_RenderCopy(renderer, iconTex, iconSrcRect, &iconRect);
+            }
             
             // 为选中的图标添加高光效果
             if (isSelected) {
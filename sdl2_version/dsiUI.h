@@ -3,9 +3,10 @@
 #include <SDL2/SDL.h>
 #include <string>
 #include <vector>
+#include "fileTypes.h"
 
 // 前向声明
-struct FileEntry;
+class FileListing;
 
 // Classic DS Menu风格UI管理器（使用3DS Light主题的DS风格资源）
 class DSiUI {
@@ -26,12 +27,12 @@ public:
     static void drawVolumeIcon(int level);
     static void drawShoulderButtons(bool leftActive, bool rightActive);
     
-    // 读取电池信息
+    // 读取电池信息（结果缓存几秒，不必每帧读取sysfs）
     static int getBatteryLevel();  // 返回0-100的电量百分比
     static bool isBatteryCharging();  // 返回是否在充电
     
     // 绘制游戏图标网格（支持文件列表）
-    static void drawGameGrid(int selectedIndex, int scrollOffset, const std::vector<struct FileEntry>* files = nullptr);
+    static void drawGameGrid(int selectedIndex, int scrollOffset, const FileListing* files = nullptr);
     
     // 绘制日期时间
     static void drawDSiDateTime();
@@ -53,9 +54,17 @@ private:
     static SDL_Texture* volumeTextures[5];
     static SDL_Texture* folderTexture;
     static SDL_Texture* ndsFileTexture;
+    static SDL_Texture* fileTypeTextures[FILE_TYPE_COUNT];   // 其他ROM类型的主题图标（按类型查表）
     static SDL_Texture* boxEmptyTexture;
     static SDL_Texture* boxFullTexture;
     
+    // 上一次读取的电池信息
+    static int batteryLevel;
+    static bool batteryCharging;
+    static bool batteryValid;
+    static Uint32 batteryReadTime;
+    static void readBattery();
+    
     static void loadTextures();
     static void freeTextures();
 };
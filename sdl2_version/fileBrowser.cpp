@@ -2,22 +2,54 @@
 #include "input.h"
 #include "graphics/textRenderer.h"
 #include "graphics/graphics.h"
-#include "dsiUI.h"
 #include "ndsIconLoader.h"
+#include "bannerCache.h"
+#include "romIO.h"
+#include "directoryScanner.h"
+#include "libraryIndex.h"
+#include "playHistory.h"
+#include "dirtyTracker.h"
+#include "collation.h"
 #include <algorithm>
-#include <sys/stat.h>
+#include <iostream>
 #include <cstring>
 #include <sstream>
 #include <iomanip>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
 
 extern SDL_Renderer* g_renderer;
 
+// ROM库搜索可输入的字符（上/下键循环选择）
+static const char LIBRARY_LETTERS[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ";
+static const int LIBRARY_LETTER_COUNT = sizeof(LIBRARY_LETTERS) - 1;
+
+// 扫描结果分块合并：每次合并都要移动整个列表，新条目积累到列表的1/8（至少256个）时才合并，
+// 大目录的合并总代价为O(n log n)；列表还没有填满前SCAN_VISIBLE_ENTRIES项时每批都合并
+static const size_t SCAN_MERGE_MIN = 256;
+static const size_t SCAN_MERGE_DIVISOR = 8;
+static const int SCAN_VISIBLE_ENTRIES = 64;
+
 FileBrowser::FileBrowser() 
-    : selectedIndex(0), active(false), scrollOffset(0), maxVisibleItems(12), filterMode(FILTER_NDS_ONLY) {
+    : selectedIndex(0), active(false), scrollOffset(0), maxVisibleItems(12), filterMode(FILTER_NDS_ONLY),
+      scanner(new DirectoryScanner()), listingMtime(), libraryMode(false), libraryLetter(0),
+      sortMode(SORT_NAME), nextEntryId(0), inotifyFd(-1), watchDescriptor(-1), changedDuringScan(false) {
+#ifdef __linux__
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        std::cerr << "无法创建inotify，目录变化只在重新进入时更新" << std::endl;
+    }
+#endif
 }
 
 FileBrowser::~FileBrowser() {
     cleanup();
+    delete scanner;
+    if (inotifyFd >= 0) {
+        close(inotifyFd);
+    }
 }
 
 bool FileBrowser::init(const std::string& startPath) {
@@ -29,125 +61,765 @@ bool FileBrowser::init(const std::string& startPath) {
 }
 
 void FileBrowser::cleanup() {
+    cancelScan();
     files.clear();
+    snapshots.clear();
+    snapshotLru.clear();
 }
 
 void FileBrowser::refreshFileList() {
+    // 取消上一个目录尚未完成的扫描
+    cancelScan();
     files.clear();
+    files.addDirectory(currentPath);
+    nextEntryId = 0;
+    invalidateSortOrders();
+    RomIO::beginScan(currentPath);
     
-    DIR* dir = opendir(currentPath.c_str());
-    if (!dir) {
-        // 如果无法打开目录，添加错误信息
-        FileEntry error;
-        error.name = "[无法打开目录]";
-        error.isDirectory = false;
-        files.push_back(error);
-        return;
+    // 记录扫描开始时目录的修改时间，用于验证快照
+    struct stat st;
+    if (stat(currentPath.c_str(), &st) == 0) {
+        listingMtime = st.st_mtim;
+    } else {
+        listingMtime = timespec();
     }
     
     // 添加 ".." 目录（如果不是根目录）
     if (currentPath != "." && currentPath != "/") {
-        FileEntry parent;
-        parent.name = "..";
-        parent.path = "..";
-        parent.isDirectory = true;
-        parent.isParent = true;
-        parent.size = 0;
-        files.push_back(parent);
-    }
-    
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr) {
-        // 跳过 "." 目录
-        if (strcmp(entry->d_name, ".") == 0) {
+        addEntryKeys(files.addEntry(0, "..", FILE_ENTRY_DIRECTORY | FILE_ENTRY_PARENT, FILE_TYPE_DIRECTORY));
+    }
+    
+    // 先开始监视，扫描期间发生的变化也不会遗漏
+    watchCurrentDirectory();
+    changedDuringScan = false;
+    
+    // 在后台线程中枚举目录，条目分批出现在列表中
+    FilterMode mode = filterMode;
+    scanner->start(currentPath, [mode](FileType type) {
+        if (mode == FILTER_NDS_ONLY) {
+            return type == FILE_TYPE_NDS;  // 只显示NDS文件
+        } else if (mode == FILTER_PNG_ONLY) {
+            return type == FILE_TYPE_PNG;  // 只显示PNG文件
+        }
+        return true;  // 显示所有文件
+    });
+    
+    // 确保选中索引有效
+    if (selectedIndex >= (int)files.size()) {
+        selectedIndex = files.size() - 1;
+    }
+    if (selectedIndex < 0) {
+        selectedIndex = 0;
+    }
+}
+
+bool FileBrowser::passesFilter(FileType type) const {
+    if (filterMode == FILTER_NDS_ONLY) {
+        return type == FILE_TYPE_NDS;
+    } else if (filterMode == FILTER_PNG_ONLY) {
+        return type == FILE_TYPE_PNG;
+    }
+    return true;
+}
+
+bool FileBrowser::pollChanges() {
+    // ROM库模式的列表来自索引，当前目录的变化在退出时处理
+    if (libraryMode) {
+        return false;
+    }
+    
+    bool changed = pollScan();
+    if (pollWatch()) {
+        changed = true;
+    }
+    return changed;
+}
+
+void FileBrowser::watchCurrentDirectory() {
+#ifdef __linux__
+    if (inotifyFd < 0) return;
+    
+    if (watchDescriptor >= 0) {
+        inotify_rm_watch(inotifyFd, watchDescriptor);
+        watchDescriptor = -1;
+    }
+    
+    // 丢弃旧目录尚未读取的事件
+    char buffer[4096];
+    while (read(inotifyFd, buffer, sizeof(buffer)) > 0) {
+    }
+    
+    // IN_CLOSE_WRITE：USB拷贝等写入完成后重新读取大小和Banner
+    watchDescriptor = inotify_add_watch(inotifyFd, currentPath.c_str(),
+                                        IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                        IN_CLOSE_WRITE | IN_DELETE_SELF | IN_MOVE_SELF);
+#endif
+}
+
+void FileBrowser::insertEntry(const std::string& name, bool isDirectory) {
+    FileType type = isDirectory ? FILE_TYPE_DIRECTORY : classifyFileName(name.c_str());
+    if (!isDirectory && !passesFilter(type)) {
+        return;
+    }
+    
+    int existing = findEntry(name);
+    if (existing >= 0) {
+        // 文件被覆盖：重新读取元数据
+        if (!files[existing].isDirectory()) {
+            files[existing].flags |= FILE_ENTRY_METADATA_PENDING;
+        }
+        return;
+    }
+    
+    addEntryKeys(files.addEntry(0, name.c_str(), isDirectory ? FILE_ENTRY_DIRECTORY : FILE_ENTRY_METADATA_PENDING, type));
+    if (!scanNames.empty()) {
+        scanNames.insert(name);
+    }
+    
+    // 已计算过的各种顺序：二分查找新编号的位置并插入，不必重新排序
+    std::vector<FileEntry>& entries = files.getEntries();
+    for (int m = 0; m < SORT_MODE_COUNT; m++) {
+        std::vector<uint32_t>& order = sortOrders[m];
+        if (order.size() + 1 != files.size()) {
+            order.clear();
             continue;
         }
+        SortMode mode = (SortMode)m;
+        loadSortKeys(entries.back(), mode);
+        const FileEntry& added = entries.back();
+        auto pos = std::upper_bound(order.begin(), order.end(), added.id, [this, &added, mode](uint32_t, uint32_t id) {
+            return compareEntries(added, files[getEntryPosition(id)], mode);
+        });
+        order.insert(pos, added.id);
+    }
+    
+    // 新条目在末尾，移动到有序列表中的对应位置
+    SortMode mode = sortMode;
+    auto pos = std::upper_bound(entries.begin(), entries.end() - 1, entries.back(), [this, mode](const FileEntry& a, const FileEntry& b) {
+        return compareEntries(a, b, mode);
+    });
+    std::rotate(pos, entries.end() - 1, entries.end());
+    letterGroups.clear();
+}
+
+bool FileBrowser::removeEntry(const std::string& name) {
+    // 扫描到但还没有合并的条目也要删除，否则合并后会重新出现
+    if (!scanBacklog.empty()) {
+        std::vector<FileEntry>& backlog = scanBacklog.getEntries();
+        backlog.erase(std::remove_if(backlog.begin(), backlog.end(), [this, &name](const FileEntry& entry) {
+            return name == scanBacklog.getName(entry);
+        }), backlog.end());
+    }
+    scanNames.erase(name);
+    
+    int index = findEntry(name);
+    if (index < 0 || files[index].isParent()) {
+        return false;
+    }
+    uint32_t id = files[index].id;
+    files.getEntries().erase(files.getEntries().begin() + index);
+    
+    // 从已计算过的顺序中删除这个编号
+    for (int m = 0; m < SORT_MODE_COUNT; m++) {
+        std::vector<uint32_t>& order = sortOrders[m];
+        auto it = order.size() == files.size() + 1 ? std::find(order.begin(), order.end(), id) : order.end();
+        if (it != order.end()) {
+            order.erase(it);
+        } else {
+            order.clear();
+        }
+    }
+    letterGroups.clear();
+    return true;
+}
+
+bool FileBrowser::pollWatch() {
+#ifdef __linux__
+    if (inotifyFd < 0 || watchDescriptor < 0) {
+        return false;
+    }
+    
+    alignas(struct inotify_event) char buffer[4096];
+    ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+    if (length <= 0) {
+        return false;
+    }
+    
+    bool hasSelection = selectedIndex >= 0 && selectedIndex < (int)files.size();
+    uint32_t selectedId = hasSelection ? files[selectedIndex].id : 0;
+    
+    bool changed = false;
+    bool needRefresh = false;
+    for (char* ptr = buffer; ptr < buffer + length; ) {
+        const struct inotify_event* event = (const struct inotify_event*)ptr;
+        ptr += sizeof(struct inotify_event) + event->len;
         
-        FileEntry file;
-        file.name = entry->d_name;
-        file.path = currentPath + "/" + entry->d_name;
-        file.isDirectory = (entry->d_type == DT_DIR);
-        file.isParent = false;
+        if (event->mask & IN_Q_OVERFLOW) {
+            // 事件队列溢出，变化已丢失：只能重新扫描
+            needRefresh = true;
+            continue;
+        }
+        if (event->wd != watchDescriptor) {
+            continue;
+        }
+        if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+            // 目录本身被删除或移动
+            needRefresh = true;
+            continue;
+        }
+        if (event->len == 0) {
+            continue;
+        }
         
-        // 根据过滤模式处理文件
-        if (file.isDirectory) {
-            // 文件夹总是显示（允许导航）
-            file.size = 0;
-            files.push_back(file);
-        } else {
-            // 文件：根据过滤模式决定是否显示
-            bool shouldShow = false;
-            
-            if (filterMode == FILTER_NONE) {
-                shouldShow = true;  // 显示所有文件
-            } else if (filterMode == FILTER_NDS_ONLY) {
-                shouldShow = DSiUI::isNDSFile(file.name);  // 只显示NDS文件
-            } else if (filterMode == FILTER_PNG_ONLY) {
-                shouldShow = isPNGFile(file.name);  // 只显示PNG文件
-            }
-            
-            if (!shouldShow) {
-                continue;  // 跳过不符合过滤条件的文件
+        std::string name = event->name;
+        bool isDirectory = (event->mask & IN_ISDIR) != 0;
+        if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+            if (removeEntry(name)) {
+                changed = true;
             }
-            
-            // 获取文件大小
-            struct stat st;
-            if (stat(file.path.c_str(), &st) == 0) {
-                file.size = st.st_size;
+        } else if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+            insertEntry(name, isDirectory);
+            changed = true;
+        } else if (event->mask & IN_CLOSE_WRITE) {
+            // 写入完成：之前读取到的可能是不完整的文件
+            int index = findEntry(name);
+            if (index >= 0) {
+                files[index].flags |= FILE_ENTRY_METADATA_PENDING;
+                NDSIconLoader::invalidate(files.getPath(files[index]));
+                changed = true;
             }
-            
-            // 如果是NDS文件，读取标题
-            if (DSiUI::isNDSFile(file.name)) {
-                file.title = NDSIconLoader::loadTitleFromNDS(file.path, 1); // 使用英语标题
-                if (file.title.empty()) {
-                    file.title = file.name;  // 如果无法读取标题，使用文件名
-                }
-            } else {
-                file.title = file.name;  // 非NDS文件使用文件名作为标题
+        }
+    }
+    
+    if (needRefresh) {
+        std::cout << "目录监视失效，重新扫描: " << currentPath << std::endl;
+        refreshFileList();
+        return true;
+    }
+    if (!changed) {
+        return false;
+    }
+    
+    if (scanner->isScanning()) {
+        changedDuringScan = true;
+    }
+    
+    // 列表已与磁盘同步，更新修改时间使快照保持有效
+    struct stat st;
+    if (stat(currentPath.c_str(), &st) == 0) {
+        listingMtime = st.st_mtim;
+    }
+    
+    // 选中项保持在同一个条目上（被删除时停在原来的位置）
+    int index = hasSelection ? getEntryPosition(selectedId) : -1;
+    if (index < 0) {
+        index = selectedIndex < (int)files.size() ? selectedIndex : (int)files.size() - 1;
+    }
+    selectedIndex = index >= 0 ? index : 0;
+    setSelectedIndex(selectedIndex);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool FileBrowser::pollScan() {
+    if (!scanner->isScanning()) {
+        return false;
+    }
+    
+    bool done = scanner->takeBatch(scanBacklog);
+    if (done) {
+        RomIO::printScanStats();
+    }
+    
+    bool changed = false;
+    size_t threshold = std::max(SCAN_MERGE_MIN, files.size() / SCAN_MERGE_DIVISOR);
+    if (!scanBacklog.empty() &&
+        (done || scanBacklog.size() >= threshold || (int)files.size() < scrollOffset + SCAN_VISIBLE_ENTRIES)) {
+        mergeScanBacklog();
+        changed = true;
+    }
+    
+    if (done) {
+        pendingSelectName.clear();
+        scanNames.clear();
+    }
+    return changed;
+}
+
+void FileBrowser::mergeScanBacklog() {
+    // 复制到列表的字符串池（扫描期间inotify已经插入的条目不再重复添加）
+    if (changedDuringScan && scanNames.empty()) {
+        for (size_t i = 0; i < files.size(); i++) {
+            scanNames.insert(files.getName(files[i]));
+        }
+    }
+    size_t oldSize = files.size();
+    for (size_t i = 0; i < scanBacklog.size(); i++) {
+        if (changedDuringScan && !scanNames.insert(scanBacklog.getName(scanBacklog[i])).second) {
+            continue;
+        }
+        addEntryKeys(files.addEntry(scanBacklog, scanBacklog[i], 0));
+    }
+    scanBacklog.clear();
+    
+    // 排序键已在扫描线程中计算，这里只比较字节
+    std::vector<FileEntry>& entries = files.getEntries();
+    auto tail = entries.begin() + oldSize;
+    SortMode mode = sortMode;
+    auto compare = [this, mode](const FileEntry& a, const FileEntry& b) {
+        return compareEntries(a, b, mode);
+    };
+    std::sort(tail, entries.end(), compare);
+    
+    // 合并是稳定的：原有条目的新位置 = 原位置 + 排在它前面的新条目数，
+    // 新条目的位置 = 在新条目中的位置 + 排在它前面的原有条目数（都用二分查找，不按名称遍历列表）
+    int index = -1;
+    if (!pendingSelectName.empty() && selectedIndex == 0) {
+        // 用户还没有移动选中项时，选中返回前所在的子目录
+        for (auto it = tail; it != entries.end(); ++it) {
+            if (pendingSelectName == files.getName(*it)) {
+                index = (it - tail) + (std::upper_bound(entries.begin(), tail, *it, compare) - entries.begin());
+                pendingSelectName.clear();
+                break;
             }
-            
-            files.push_back(file);
         }
     }
+    if (index < 0 && selectedIndex >= 0 && selectedIndex < (int)oldSize) {
+        index = selectedIndex + (std::lower_bound(tail, entries.end(), entries[selectedIndex], compare) - tail);
+    }
+    std::inplace_merge(entries.begin(), tail, entries.end(), compare);
+    invalidateSortOrders();
     
-    closedir(dir);
+    selectedIndex = index >= 0 ? index : 0;
+    setSelectedIndex(selectedIndex);
+}
+
+void FileBrowser::cancelScan() {
+    scanner->cancel();
+    scanBacklog.clear();
+    scanNames.clear();
+}
+
+bool FileBrowser::isScanning() const {
+    return scanner->isScanning();
+}
+
+void FileBrowser::ensureMetadata(int first, int last) {
+    if (first < 0) first = 0;
+    if (last >= (int)files.size()) last = files.size() - 1;
     
-    sortFiles();
+    for (int i = first; i <= last; i++) {
+        FileEntry& file = files[i];
+        if (!file.metadataPending()) continue;
+        
+        // NDS文件：标题和大小来自Banner缓存（未命中时后台读取）
+        std::string path = files.getPath(file);
+        if (file.type == FILE_TYPE_NDS) {
+            std::string title;
+            uint64_t size = 0;
+            NDSMetadataState state = NDSIconLoader::requestTitle(path, 1, title, size);  // 使用英语标题
+            if (state == NDS_METADATA_PENDING) {
+                continue;
+            }
+            if (state == NDS_METADATA_READY) {
+                if (!title.empty()) {
+                    // 标题排序键已经用于排序时只更新显示的标题：在有序的列表中改变排序键会破坏
+                    // 插入和合并使用的二分查找（Banner缓存未命中的条目在本次列表中一直按文件名排序）
+                    if (file.flags & FILE_ENTRY_TITLE_LOADED) {
+                        files.setDisplayTitle(file, title);
+                    } else {
+                        files.setTitle(file, title);
+                    }
+                }
+                file.size = size;
+                file.flags &= ~FILE_ENTRY_METADATA_PENDING;
+                DirtyTracker::invalidate();
+                continue;
+            }
+        }
+        
+        // 其他文件（或无法读取Banner）：只获取文件大小，标题使用文件名
+        struct stat st;
+        if (stat(path.c_str(), &st) == 0) {
+            file.size = st.st_size;
+        }
+        file.flags &= ~FILE_ENTRY_METADATA_PENDING;
+        DirtyTracker::invalidate();
+    }
+}
+
+int FileBrowser::findEntry(const std::string& name) {
+    // 在名称顺序中二分查找：按名称排序时就是列表本身，否则使用（缓存的）名称顺序
+    std::vector<uint32_t>* order = sortMode != SORT_NAME ? &getSortOrder(SORT_NAME) : nullptr;
+    std::string key = makeCollationKey(name);
+    int count = files.size();
     
-    // 确保选中索引有效
-    if (selectedIndex >= (int)files.size()) {
-        selectedIndex = files.size() - 1;
+    // 目录和文件分别查找（inotify事件不把指向目录的符号链接当作目录）
+    for (int pass = 0; pass < 2; pass++) {
+        bool isDirectory = pass == 0;
+        int low = 0;
+        int high = count;
+        while (low < high) {
+            int mid = (low + high) / 2;
+            int index = order ? getEntryPosition((*order)[mid]) : mid;
+            if (compareName(files[index], isDirectory, key.c_str(), name.c_str()) < 0) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (low < count) {
+            int index = order ? getEntryPosition((*order)[low]) : low;
+            if (compareName(files[index], isDirectory, key.c_str(), name.c_str()) == 0) {
+                return index;
+            }
+        }
     }
-    if (selectedIndex < 0) {
-        selectedIndex = 0;
+    return -1;
+}
+
+int FileBrowser::compareName(const FileEntry& entry, bool isDirectory, const char* key, const char* name) const {
+    // 与compareEntries按名称排序时的顺序相同：".."、目录、文件，再按排序键和原始名称
+    if (entry.isParent()) return -1;
+    if (entry.isDirectory() != isDirectory) return entry.isDirectory() ? -1 : 1;
+    int result = strcmp(files.getSortKey(entry), key);
+    if (result != 0) return result;
+    return strcmp(files.getName(entry), name);
+}
+
+int FileBrowser::getEntryPosition(uint32_t id) {
+    if (id < entryPositions.size()) {
+        int pos = entryPositions[id];
+        if (pos >= 0 && pos < (int)files.size() && files[pos].id == id) {
+            return pos;
+        }
     }
+    
+    // 列表插入、删除或重排后重新计算（只比较整数）
+    entryPositions.assign(nextEntryId, -1);
+    for (size_t i = 0; i < files.size(); i++) {
+        if (files[i].id < nextEntryId) {
+            entryPositions[files[i].id] = i;
+        }
+    }
+    return id < entryPositions.size() ? entryPositions[id] : -1;
 }
 
 void FileBrowser::sortFiles() {
-    std::sort(files.begin(), files.end(), compareEntries);
+    invalidateSortOrders();
+    applySortOrder();
 }
 
-bool FileBrowser::compareEntries(const FileEntry& a, const FileEntry& b) {
+bool FileBrowser::compareEntries(const FileEntry& a, const FileEntry& b, SortMode mode) const {
     // ".." 总是在最前面
-    if (a.isParent) return true;
-    if (b.isParent) return false;
+    if (a.isParent() != b.isParent()) return a.isParent();
     
     // 目录优先
-    if (a.isDirectory && !b.isDirectory) return true;
-    if (!a.isDirectory && b.isDirectory) return false;
+    if (a.isDirectory() != b.isDirectory()) return a.isDirectory();
+    
+    switch (mode) {
+        case SORT_TITLE: {
+            int result = strcmp(files.getTitleKey(a), files.getTitleKey(b));
+            if (result != 0) return result < 0;
+            break;
+        }
+        case SORT_SIZE:
+            if (a.size != b.size) return a.size > b.size;
+            break;
+        case SORT_MTIME:
+            if (a.mtime != b.mtime) return a.mtime > b.mtime;
+            break;
+        case SORT_PLAY_COUNT:
+            if (a.playCount != b.playCount) return a.playCount > b.playCount;
+            break;
+        default:
+            break;
+    }
+    
+    // 按名称排序（自然顺序，忽略大小写；排序键相同时按原始字节区分）
+    int result = strcmp(files.getSortKey(a), files.getSortKey(b));
+    if (result != 0) return result < 0;
+    return strcmp(files.getName(a), files.getName(b)) < 0;
+}
+
+void FileBrowser::addEntryKeys(FileEntry& entry) {
+    entry.id = nextEntryId++;
+    loadSortKeys(entry, sortMode);
+}
+
+void FileBrowser::loadSortKeys(FileEntry& entry, SortMode mode) {
+    // 大小和修改时间只在需要时读取，每个条目只stat一次
+    if ((mode == SORT_SIZE || mode == SORT_MTIME) && !(entry.flags & FILE_ENTRY_STAT_LOADED) && !entry.isParent()) {
+        struct stat st;
+        if (stat(files.getPath(entry).c_str(), &st) == 0) {
+            if (!entry.isDirectory()) {
+                entry.size = st.st_size;
+            }
+            entry.mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+        }
+        entry.flags |= FILE_ENTRY_STAT_LOADED;
+    }
+    // 标题只读取一次：NDS文件的标题来自Banner缓存（只查索引和读取一条记录，不读ROM），
+    // 未命中（还没有读取过Banner）的按文件名排序
+    if (mode == SORT_TITLE && !(entry.flags & FILE_ENTRY_TITLE_LOADED)) {
+        if (entry.type == FILE_TYPE_NDS && entry.title == FileListing::NO_STRING) {
+            BannerCacheEntry cached;
+            if (BannerCache::lookupCopy(files.getPath(entry), cached)) {
+                std::string title = selectNDSTitle(cached.titles, 1);  // 与列表显示的英语标题相同
+                if (!title.empty()) {
+                    files.setTitle(entry, title);
+                }
+                entry.size = cached.size;
+                entry.flags &= ~FILE_ENTRY_METADATA_PENDING;
+            }
+        }
+        entry.flags |= FILE_ENTRY_TITLE_LOADED;
+    }
+    if (mode == SORT_PLAY_COUNT && entry.playCount < 0) {
+        entry.playCount = entry.isDirectory() ? 0 : PlayHistory::getCount(files.getPath(entry));
+    }
+}
+
+void FileBrowser::invalidateSortOrders() {
+    for (int mode = 0; mode < SORT_MODE_COUNT; mode++) {
+        sortOrders[mode].clear();
+    }
+    letterGroups.clear();
+}
+
+std::vector<uint32_t>& FileBrowser::getSortOrder(SortMode mode) {
+    std::vector<uint32_t>& order = sortOrders[mode];
+    if (order.size() != files.size()) {
+        // 这种排序方式还没有计算过：读取排序需要的数据，按编号排序一次
+        std::vector<const FileEntry*> entries;
+        entries.reserve(files.size());
+        for (FileEntry& entry : files.getEntries()) {
+            loadSortKeys(entry, mode);
+            entries.push_back(&entry);
+        }
+        std::sort(entries.begin(), entries.end(), [this, mode](const FileEntry* a, const FileEntry* b) {
+            return compareEntries(*a, *b, mode);
+        });
+        order.clear();
+        for (const FileEntry* entry : entries) {
+            order.push_back(entry->id);
+        }
+    }
+    return order;
+}
+
+void FileBrowser::applySortOrder() {
+    if (files.empty()) {
+        return;
+    }
+    
+    // 按编号重排列表，选中项保持在同一个条目上
+    const std::vector<uint32_t>& order = getSortOrder(sortMode);
+    uint32_t selectedId = selectedIndex >= 0 && selectedIndex < (int)files.size() ? files[selectedIndex].id : 0;
+    std::vector<FileEntry> sorted;
+    sorted.reserve(files.size());
+    for (uint32_t id : order) {
+        sorted.push_back(files[getEntryPosition(id)]);
+    }
+    files.getEntries().swap(sorted);
+    letterGroups.clear();
+    
+    scrollOffset = 0;
+    for (size_t i = 0; i < files.size(); i++) {
+        if (files[i].id == selectedId) {
+            selectedIndex = i;
+            break;
+        }
+    }
+    setSelectedIndex(selectedIndex);
+}
+
+void FileBrowser::setSortMode(SortMode mode) {
+    if (mode == sortMode || mode < 0 || mode >= SORT_MODE_COUNT) {
+        return;
+    }
+    sortMode = mode;
+    
+    // 搜索结果按匹配程度排列，退出ROM库模式时再按新的方式排序
+    if (!libraryMode) {
+        applySortOrder();
+    }
+}
+
+const char* FileBrowser::getSortModeName(SortMode mode) {
+    switch (mode) {
+        case SORT_TITLE: return "title";
+        case SORT_SIZE: return "size";
+        case SORT_MTIME: return "mtime";
+        case SORT_PLAY_COUNT: return "playcount";
+        default: return "name";
+    }
+}
+
+FileBrowser::SortMode FileBrowser::parseSortMode(const std::string& name) {
+    for (int mode = 0; mode < SORT_MODE_COUNT; mode++) {
+        if (name == getSortModeName((SortMode)mode)) {
+            return (SortMode)mode;
+        }
+    }
+    return SORT_NAME;
+}
+
+int FileBrowser::getEntryLetter(int index) const {
+    const FileEntry& entry = files[index];
+    if (entry.isParent()) {
+        return 0;
+    }
+    // 排序键已经转成小写，数字开头的键以'0'开头
+    char c = sortMode == SORT_TITLE ? files.getTitleKey(entry)[0] : files.getSortKey(entry)[0];
+    return (c >= 'a' && c <= 'z') ? c - 'a' + 1 : 0;
+}
+
+void FileBrowser::buildLetterIndex() {
+    if (!letterGroups.empty() || files.empty()) {
+        return;
+    }
+    
+    for (int letter = 0; letter < LETTER_COUNT; letter++) {
+        letterStarts[letter] = -1;
+    }
+    for (int i = 0; i < (int)files.size(); i++) {
+        int letter = getEntryLetter(i);
+        if (letterGroups.empty() || letterGroups.back().letter != letter) {
+            letterGroups.push_back({i, letter});
+        }
+        if (letterStarts[letter] < 0) {
+            letterStarts[letter] = i;
+        }
+    }
+}
+
+int FileBrowser::getLetterStart(int letter) {
+    buildLetterIndex();
+    if (letterGroups.empty() || letter < 0 || letter >= LETTER_COUNT) {
+        return -1;
+    }
+    return letterStarts[letter];
+}
+
+int FileBrowser::getLetterGroupStart(int index, int delta) {
+    buildLetterIndex();
+    if (letterGroups.empty()) {
+        return 0;
+    }
+    
+    // index所在的组（组按起始位置递增）
+    auto it = std::upper_bound(letterGroups.begin(), letterGroups.end(), index,
+                               [](int i, const LetterGroup& group) { return i < group.start; });
+    int group = std::max(0, (int)(it - letterGroups.begin()) - 1);
     
-    // 按名称排序
-    return a.name < b.name;
+    // 向前跳时如果不在组的开头，先回到本组开头
+    if (delta < 0 && index > letterGroups[group].start) {
+        delta++;
+    }
+    group = std::max(0, std::min((int)letterGroups.size() - 1, group + delta));
+    return letterGroups[group].start;
+}
+
+std::string FileBrowser::snapshotKey() const {
+    return std::to_string((int)filterMode) + ":" + currentPath;
+}
+
+void FileBrowser::saveSnapshot() {
+    // 只保存扫描完整的目录列表
+    if (libraryMode || scanner->isScanning() || files.empty()) {
+        return;
+    }
+    
+    std::string key = snapshotKey();
+    auto it = snapshots.find(key);
+    if (it == snapshots.end()) {
+        // 淘汰最久未访问的快照
+        if (snapshots.size() >= MAX_SNAPSHOTS) {
+            snapshots.erase(snapshotLru.back());
+            snapshotLru.pop_back();
+        }
+        snapshotLru.push_front(key);
+        it = snapshots.insert(std::make_pair(key, DirectorySnapshot())).first;
+        it->second.lruPos = snapshotLru.begin();
+    } else {
+        snapshotLru.splice(snapshotLru.begin(), snapshotLru, it->second.lruPos);
+    }
+    
+    DirectorySnapshot& snapshot = it->second;
+    snapshot.files = files;
+    snapshot.selectedIndex = selectedIndex;
+    snapshot.scrollOffset = scrollOffset;
+    snapshot.sortMode = sortMode;
+    snapshot.nextEntryId = nextEntryId;
+    for (int mode = 0; mode < SORT_MODE_COUNT; mode++) {
+        snapshot.sortOrders[mode] = sortOrders[mode];
+    }
+    snapshot.mtime = listingMtime;
+}
+
+bool FileBrowser::restoreSnapshot(const struct stat& dirStat) {
+    auto it = snapshots.find(snapshotKey());
+    if (it == snapshots.end()) {
+        return false;
+    }
+    
+    // 目录内容变化后（修改时间不同）快照失效
+    DirectorySnapshot& snapshot = it->second;
+    if (snapshot.mtime.tv_sec != dirStat.st_mtim.tv_sec || snapshot.mtime.tv_nsec != dirStat.st_mtim.tv_nsec) {
+        snapshotLru.erase(snapshot.lruPos);
+        snapshots.erase(it);
+        return false;
+    }
+    
+    cancelScan();
+    watchCurrentDirectory();
+    snapshotLru.splice(snapshotLru.begin(), snapshotLru, snapshot.lruPos);
+    files = snapshot.files;
+    listingMtime = snapshot.mtime;
+    selectedIndex = snapshot.selectedIndex;
+    scrollOffset = snapshot.scrollOffset;
+    nextEntryId = snapshot.nextEntryId;
+    pendingSelectName.clear();
+    
+    // 恢复保存时已计算过的顺序；快照保存后切换过排序方式时直接按编号重排
+    for (int mode = 0; mode < SORT_MODE_COUNT; mode++) {
+        sortOrders[mode] = snapshot.sortOrders[mode];
+    }
+    letterGroups.clear();
+    if (snapshot.sortMode != sortMode) {
+        applySortOrder();
+    }
+    return true;
 }
 
 bool FileBrowser::changeDirectory(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return false;
+    }
+    
+    // 保存当前目录的快照，再切换
+    saveSnapshot();
+    libraryMode = false;
+    std::string previousPath = currentPath;
+    currentPath = path;
+    pendingSelectName.clear();
+    
+    // 快照仍然有效：不需要任何目录读取
+    if (restoreSnapshot(st)) {
+        return true;
+    }
+    
     DIR* dir = opendir(path.c_str());
     if (!dir) {
+        currentPath = previousPath;
         return false;
     }
     closedir(dir);
     
-    currentPath = path;
     selectedIndex = 0;
     scrollOffset = 0;
     refreshFileList();
@@ -166,13 +838,21 @@ bool FileBrowser::enterDirectory(const std::string& name) {
 
 bool FileBrowser::goUp() {
     size_t lastSlash = currentPath.find_last_of('/');
+    std::string childName = lastSlash != std::string::npos ? currentPath.substr(lastSlash + 1) : currentPath;
+    
+    bool changed = false;
     if (lastSlash != std::string::npos && lastSlash > 0) {
         std::string newPath = currentPath.substr(0, lastSlash);
-        return changeDirectory(newPath);
+        changed = changeDirectory(newPath);
     } else if (currentPath != ".") {
-        return changeDirectory(".");
+        changed = changeDirectory(".");
     }
-    return false;
+    
+    // 重新扫描的上级目录：扫描到原来的子目录时选中它
+    if (changed && scanner->isScanning()) {
+        pendingSelectName = childName;
+    }
+    return changed;
 }
 
 void FileBrowser::setSelectedIndex(int index) {
@@ -196,6 +876,7 @@ FileEntry* FileBrowser::getSelectedEntry() {
 }
 
 void FileBrowser::update() {
+    pollChanges();
     if (!active) return;
     
     // 处理输入
@@ -210,10 +891,10 @@ void FileBrowser::update() {
     if (InputManager::isKeyDown(KEY_A)) {
         FileEntry* entry = getSelectedEntry();
         if (entry) {
-            if (entry->isParent) {
+            if (entry->isParent()) {
                 goUp();
-            } else if (entry->isDirectory) {
-                enterDirectory(entry->name);
+            } else if (entry->isDirectory()) {
+                enterDirectory(files.getName(*entry));
             } else {
                 // 文件选择
                 // TODO: 处理文件选择
@@ -248,6 +929,12 @@ void FileBrowser::render() {
     if (displayPath.length() > 30) {
         displayPath = "..." + displayPath.substr(displayPath.length() - 27);
     }
+    if (libraryMode) {
+        displayPath = "ROM库: " + libraryQuery + "_";
+    }
+    if (isScanning() || (libraryMode && LibraryIndex::isUpdating())) {
+        displayPath += " ...";
+    }
     TextRenderer::drawText(10, 25, displayPath, pathColor, 10);
     
     // 绘制分隔线
@@ -260,6 +947,9 @@ void FileBrowser::render() {
     int visibleStart = scrollOffset;
     int visibleEnd = std::min(visibleStart + maxVisibleItems, (int)files.size());
     
+    // 只为可见的条目（以及下一页的开头）读取大小和标题
+    ensureMetadata(visibleStart, visibleEnd + 2);
+    
     for (int i = visibleStart; i < visibleEnd; i++) {
         int y = startY + (i - visibleStart) * itemHeight;
         
@@ -274,15 +964,18 @@ void FileBrowser::render() {
         SDL_Color textColor;
         if (i == selectedIndex) {
             textColor = {255, 255, 255, 255};
-        } else if (files[i].isDirectory) {
+        } else if (files[i].isDirectory()) {
             textColor = {150, 200, 255, 255};
         } else {
             textColor = {200, 200, 200, 255};
         }
         
-        std::string displayName = files[i].name;
-        if (files[i].isDirectory) {
+        std::string displayName = files.getName(files[i]);
+        if (files[i].isDirectory()) {
             displayName = "[DIR] " + displayName;
+        } else if (files[i].metadataPending()) {
+            // 大小尚未读取
+            displayName = "[...] " + displayName;
         } else {
             // 显示文件大小
             std::ostringstream oss;
@@ -311,7 +1004,9 @@ void FileBrowser::render() {
         int totalHeight = maxVisibleItems * itemHeight;
         int scrollBarHeight = (totalHeight * maxVisibleItems) / files.size();
         if (scrollBarHeight < 10) scrollBarHeight = 10;
-        int scrollBarY = startY + (scrollOffset * totalHeight) / files.size();
+        // 按可滚动范围换算位置：滚动到底时滑块正好在底部（条目很多时滑块有最小高度）
+        int maxScroll = files.size() - maxVisibleItems;
+        int scrollBarY = startY + (int)((int64_t)scrollOffset * (totalHeight - scrollBarHeight) / maxScroll);
         SDL_SetRenderDrawColor(g_renderer, 100, 100, 100, 255);
         SDL_Rect scrollBar = {235, scrollBarY, 5, scrollBarHeight};
         SDL_RenderFillRect(g_renderer, &scrollBar);
@@ -322,23 +1017,113 @@ void FileBrowser::render() {
     TextRenderer::drawText(10, 360, "A: Open/Select  B: Back  ESC: Exit", hintColor, 9);
 }
 
-bool FileBrowser::isPNGFile(const std::string& filename) {
-    // 转换为小写进行比较
-    std::string lowerName = filename;
-    std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+std::string FileBrowser::getSelectedFilePath() const {
+    if (selectedIndex >= 0 && selectedIndex < (int)files.size()) {
+        return files.getPath(files[selectedIndex]);
+    }
+    return "";
+}
+
+
+void FileBrowser::setLibraryMode(bool enabled) {
+    if (enabled == libraryMode) {
+        return;
+    }
     
-    // 检查PNG扩展名
-    if (lowerName.length() >= 4) {
-        std::string ext = lowerName.substr(lowerName.length() - 4);
-        return ext == ".png";
+    if (enabled) {
+        // 保存目录快照，退出ROM库模式时不需要重新扫描
+        saveSnapshot();
+        cancelScan();
+        libraryMode = true;
+        libraryQuery.clear();
+        applyLibraryQuery("");
+        
+        // 后台检查ROM目录的变化，更新完成后刷新结果
+        LibraryIndex::startUpdate();
+    } else {
+        libraryMode = false;
+        selectedIndex = 0;
+        scrollOffset = 0;
+        struct stat st;
+        if (stat(currentPath.c_str(), &st) != 0 || !restoreSnapshot(st)) {
+            refreshFileList();
+        }
     }
-    return false;
 }
 
-std::string FileBrowser::getSelectedFilePath() const {
-    if (selectedIndex >= 0 && selectedIndex < (int)files.size()) {
-        return files[selectedIndex].path;
+char FileBrowser::getLibraryLetter() const {
+    return LIBRARY_LETTERS[libraryLetter];
+}
+
+bool FileBrowser::handleLibraryInput() {
+    if (!libraryMode) {
+        return false;
+    }
+    
+    if (InputManager::isKeyDown(KEY_UP)) {
+        libraryLetter = (libraryLetter + LIBRARY_LETTER_COUNT - 1) % LIBRARY_LETTER_COUNT;
+    }
+    if (InputManager::isKeyDown(KEY_DOWN)) {
+        libraryLetter = (libraryLetter + 1) % LIBRARY_LETTER_COUNT;
+    }
+    
+    bool changed = false;
+    if (InputManager::isKeyDown(KEY_Y)) {
+        libraryQuery += LIBRARY_LETTERS[libraryLetter];
+        changed = true;
+    }
+    if (InputManager::isKeyDown(KEY_X) && !libraryQuery.empty()) {
+        libraryQuery.erase(libraryQuery.size() - 1);
+        changed = true;
+    }
+    
+    // 搜索词变化后选中最匹配的第一项
+    if (changed) {
+        applyLibraryQuery("");
+    }
+    return changed;
+}
+
+void FileBrowser::refreshLibraryResults() {
+    if (libraryMode) {
+        applyLibraryQuery(getSelectedFilePath());
     }
-    return "";
 }
 
+void FileBrowser::applyLibraryQuery(const std::string& selectPath) {
+    std::vector<uint32_t> results;
+    LibraryIndex::search(libraryQuery, results);
+    
+    // 标题和大小都来自索引，不需要读取元数据
+    files.clear();
+    files.getEntries().reserve(results.size());
+    nextEntryId = 0;
+    invalidateSortOrders();
+    
+    // 索引的目录 -> 列表的目录表，路径在需要时拼接
+    std::map<uint32_t, uint32_t> dirs;
+    for (uint32_t index : results) {
+        const LibraryIndex::Record& record = LibraryIndex::getRecord(index);
+        auto dir = dirs.find(record.dir);
+        if (dir == dirs.end()) {
+            dir = dirs.insert(std::make_pair(record.dir, files.addDirectory(LibraryIndex::getDirectory(record.dir)))).first;
+        }
+        
+        FileEntry& file = files.addEntry(dir->second, LibraryIndex::getName(index), 0, FILE_TYPE_NDS);
+        const char* title = LibraryIndex::getTitle(index);
+        if (title[0] != '\0') {
+            files.setTitle(file, title);
+        }
+        file.size = record.size;
+        file.id = nextEntryId++;
+    }
+    
+    selectedIndex = 0;
+    scrollOffset = 0;
+    for (size_t i = 0; !selectPath.empty() && i < files.size(); i++) {
+        if (files.getPath(files[i]) == selectPath) {
+            setSelectedIndex(i);
+            break;
+        }
+    }
+}
@@ -2,18 +2,15 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <list>
+#include <unordered_set>
+#include <cstdint>
 #include <dirent.h>
+#include <sys/stat.h>
+#include "fileListing.h"
 
-struct FileEntry {
-    std::string name;
-    std::string path;
-    std::string title;  // NDS文件内部标题
-    bool isDirectory;
-    bool isParent;  // ".." 目录
-    size_t size;
-    
-    FileEntry() : isDirectory(false), isParent(false), size(0) {}
-};
+class DirectoryScanner;
 
 class FileBrowser {
 public:
@@ -28,8 +25,8 @@ public:
     bool enterDirectory(const std::string& name);
     bool goUp();
     
-    // 获取文件列表
-    const std::vector<FileEntry>& getFiles() const { return files; }
+    // 获取文件列表（条目的名称、标题和路径通过列表获取）
+    const FileListing& getFiles() const { return files; }
     std::string getCurrentPath() const { return currentPath; }
     
     // 选择
@@ -37,6 +34,17 @@ public:
     void setSelectedIndex(int index);
     FileEntry* getSelectedEntry();
     
+    // 合并后台扫描到的条目和目录变化（每帧调用），列表有变化时返回true
+    bool pollChanges();
+    bool pollScan();
+    bool isScanning() const;
+    
+    // 读取[first, last]范围内条目的标题和大小（可见及即将可见的条目，每帧调用）
+    void ensureMetadata(int first, int last);
+    
+    // 按名称查找条目（在名称顺序中二分查找），找不到返回-1
+    int findEntry(const std::string& name);
+    
     // 更新和渲染
     void update();
     void render();
@@ -50,24 +58,121 @@ public:
         FILTER_NDS_ONLY,  // 只显示NDS文件
         FILTER_PNG_ONLY   // 只显示PNG文件
     };
-    void setFilterMode(FilterMode mode) { filterMode = mode; refreshFileList(); }
+    void setFilterMode(FilterMode mode) { filterMode = mode; libraryMode = false; refreshFileList(); }
     FilterMode getFilterMode() const { return filterMode; }
     
+    // 排序方式（目录总是在文件之前）
+    enum SortMode {
+        SORT_NAME,        // 文件名（自然顺序，忽略大小写）
+        SORT_TITLE,       // Banner标题
+        SORT_SIZE,        // 文件大小（大的在前）
+        SORT_MTIME,       // 修改时间（新的在前）
+        SORT_PLAY_COUNT,  // 启动次数（多的在前）
+        SORT_MODE_COUNT
+    };
+    // 切换排序方式：已计算过的顺序直接按编号重排（O(n)），不再比较字符串
+    void setSortMode(SortMode mode);
+    SortMode getSortMode() const { return sortMode; }
+    static const char* getSortModeName(SortMode mode);
+    static SortMode parseSortMode(const std::string& name);
+    
+    // 首字母索引（0为'#'，1-26为A-Z）：当前顺序中首字母相同的连续条目为一组
+    // 列表或顺序变化后第一次使用时重新计算（O(n)），之后的跳转不再遍历列表
+    static const int LETTER_COUNT = 27;
+    static char getLetterName(int letter) { return letter == 0 ? '#' : 'A' + letter - 1; }
+    int getEntryLetter(int index) const;
+    int getLetterStart(int letter);                  // 该字母第一个条目的位置，没有时返回-1
+    int getLetterGroupStart(int index, int delta);   // 从index所在的组向前/后移动delta组，返回该组第一个条目
+    
     // 获取选中的文件路径（用于壁纸选择）
     std::string getSelectedFilePath() const;
     
+    // ROM库模式：列表为所有ROM根目录中标题匹配搜索词的ROM（来自索引，不遍历目录）
+    void setLibraryMode(bool enabled);
+    bool isLibraryMode() const { return libraryMode; }
+    const std::string& getLibraryQuery() const { return libraryQuery; }
+    char getLibraryLetter() const;
+    
+    // 处理搜索输入（上/下选择字符，Y输入，X删除），列表有变化时返回true
+    bool handleLibraryInput();
+    
+    // 用当前搜索词重新生成列表（索引更新后调用）
+    void refreshLibraryResults();
+    
 private:
-    std::vector<FileEntry> files;
+    FileListing files;
     std::string currentPath;
     int selectedIndex;
     bool active;
     int scrollOffset;
     int maxVisibleItems;
     FilterMode filterMode;
+    DirectoryScanner* scanner;
+    struct timespec listingMtime;   // 扫描开始时目录的修改时间
+    std::string pendingSelectName;  // 扫描到该条目时选中它（返回上级目录时选中原来的子目录）
+    FileListing scanBacklog;        // 已扫描、尚未合并到列表中的条目（分块合并）
+    std::unordered_set<std::string> scanNames;  // 列表中的名称（只在扫描期间目录有变化时建立，合并时去重）
+    void cancelScan();
+    void mergeScanBacklog();
+    
+    bool libraryMode;
+    std::string libraryQuery;
+    int libraryLetter;              // 当前可输入的字符（LIBRARY_LETTERS中的下标）
+    
+    // 每种排序方式的条目编号顺序（为空表示需要重新计算；目录变化时插入/删除对应的编号，重新扫描时全部失效）
+    SortMode sortMode;
+    std::vector<uint32_t> sortOrders[SORT_MODE_COUNT];
+    uint32_t nextEntryId;
+    std::vector<int> entryPositions;   // 条目编号 -> 列表中的位置（使用时验证，过期时重新计算）
+    void addEntryKeys(FileEntry& entry);
+    void loadSortKeys(FileEntry& entry, SortMode mode);
+    void invalidateSortOrders();
+    std::vector<uint32_t>& getSortOrder(SortMode mode);
+    void applySortOrder();
+    int getEntryPosition(uint32_t id);
+    int compareName(const FileEntry& entry, bool isDirectory, const char* key, const char* name) const;
+    
+    struct LetterGroup {
+        int start;
+        int letter;
+    };
+    std::vector<LetterGroup> letterGroups;  // 为空表示需要重新计算
+    int letterStarts[LETTER_COUNT];
+    void buildLetterIndex();
+    
+    // inotify监视当前目录（非Linux平台为-1）
+    int inotifyFd;
+    int watchDescriptor;
+    bool changedDuringScan;         // 扫描期间收到过目录变化（合并时需要去重）
+    void watchCurrentDirectory();
+    bool pollWatch();
+    void insertEntry(const std::string& name, bool isDirectory);
+    bool removeEntry(const std::string& name);
+    bool passesFilter(FileType type) const;
+    
+    // 最近访问的目录快照：返回时不需要重新扫描，并恢复选中位置
+    struct DirectorySnapshot {
+        FileListing files;
+        int selectedIndex;
+        int scrollOffset;
+        SortMode sortMode;
+        uint32_t nextEntryId;
+        std::vector<uint32_t> sortOrders[SORT_MODE_COUNT];  // 保存时已计算过的顺序
+        struct timespec mtime;
+        std::list<std::string>::iterator lruPos;
+    };
+    static const size_t MAX_SNAPSHOTS = 8;
+    std::map<std::string, DirectorySnapshot> snapshots;
+    std::list<std::string> snapshotLru;  // 最近使用的在前
+    
+    std::string snapshotKey() const;
+    void saveSnapshot();
+    bool restoreSnapshot(const struct stat& dirStat);
+    
+    void applyLibraryQuery(const std::string& selectPath);
     
     void refreshFileList();
     void sortFiles();
-    static bool compareEntries(const FileEntry& a, const FileEntry& b);
-    static bool isPNGFile(const std::string& filename);
+    bool compareEntries(const FileEntry& a, const FileEntry& b, SortMode mode) const;
 };
 
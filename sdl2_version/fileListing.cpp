@@ -0,0 +1,94 @@
+#include "fileListing.h"
+#include "collation.h"
+#include <cstring>
+
+void FileListing::clear() {
+    entries.clear();
+    dirs.clear();
+    strings.clear();
+}
+
+uint32_t FileListing::addString(const char* str, size_t length) {
+    uint32_t offset = strings.size();
+    strings.insert(strings.end(), str, str + length);
+    strings.push_back('\0');
+    return offset;
+}
+
+uint32_t FileListing::addDirectory(const std::string& path) {
+    dirs.push_back(addString(path));
+    return dirs.size() - 1;
+}
+
+FileEntry& FileListing::addEntry(uint32_t dir, const char* name, uint8_t flags, FileType type) {
+    FileEntry entry;
+    entry.name = addString(name, strlen(name));
+    entry.title = NO_STRING;
+    entry.sortKey = addString(makeCollationKey(name));
+    entry.titleKey = NO_STRING;
+    entry.dir = dir;
+    entry.id = 0;
+    entry.playCount = -1;
+    entry.type = type;
+    entry.flags = flags;
+    entry.size = 0;
+    entry.mtime = 0;
+    entries.push_back(entry);
+    return entries.back();
+}
+
+FileEntry& FileListing::addEntry(const FileListing& other, const FileEntry& source, uint32_t dir) {
+    FileEntry entry = source;
+    entry.name = addString(other.getName(source));
+    entry.sortKey = addString(other.getSortKey(source));
+    if (source.title != NO_STRING) {
+        entry.title = addString(other.getString(source.title));
+    }
+    if (source.titleKey != NO_STRING) {
+        entry.titleKey = addString(other.getString(source.titleKey));
+    }
+    entry.dir = dir;
+    entries.push_back(entry);
+    return entries.back();
+}
+
+void FileListing::append(const FileListing& other, uint32_t dir) {
+    entries.reserve(entries.size() + other.size());
+    for (const FileEntry& entry : other.entries) {
+        addEntry(other, entry, dir);
+    }
+}
+
+const char* FileListing::getTitleKey(const FileEntry& entry) const {
+    return getString(entry.titleKey != NO_STRING ? entry.titleKey : entry.sortKey);
+}
+
+const char* FileListing::getTitle(const FileEntry& entry) const {
+    return getString(entry.title != NO_STRING ? entry.title : entry.name);
+}
+
+void FileListing::setTitle(FileEntry& entry, const std::string& title) {
+    entry.title = addString(title);
+    entry.titleKey = addString(makeCollationKey(title));
+}
+
+void FileListing::setDisplayTitle(FileEntry& entry, const std::string& title) {
+    if (entry.titleKey == NO_STRING) {
+        // 排序时没有标题（按文件名排序）：固定使用文件名的排序键
+        entry.titleKey = entry.sortKey;
+    }
+    entry.title = addString(title);
+}
+
+std::string FileListing::getPath(const FileEntry& entry) const {
+    std::string path = getDirectory(entry.dir);
+    if (path.empty() || path.back() != '/') {
+        path += '/';
+    }
+    path += getName(entry);
+    return path;
+}
+
+size_t FileListing::getBytesUsed() const {
+    return entries.capacity() * sizeof(FileEntry) + dirs.capacity() * sizeof(uint32_t) + strings.capacity();
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "fileTypes.h"
+
+// 条目标志
+enum FileEntryFlags : uint8_t {
+    FILE_ENTRY_DIRECTORY = 1 << 0,
+    FILE_ENTRY_PARENT = 1 << 1,            // ".." 目录
+    FILE_ENTRY_METADATA_PENDING = 1 << 2,  // 标题和大小尚未读取（显示文件名）
+    FILE_ENTRY_STAT_LOADED = 1 << 3,       // size和mtime已经通过stat读取
+    FILE_ENTRY_TITLE_LOADED = 1 << 4       // 标题排序键已确定（之后读取到的标题只用于显示）
+};
+
+// 文件列表中的一个条目：定长的POD记录，字符串都在所属FileListing的字符串池中，
+// 路径在需要时由 目录 + 文件名 拼接
+struct FileEntry {
+    uint32_t name;       // 文件名在字符串池中的偏移
+    uint32_t title;      // 标题（NO_STRING表示尚未读取，显示文件名）
+    uint32_t sortKey;    // 文件名的排序键（makeCollationKey）
+    uint32_t titleKey;   // 标题的排序键（NO_STRING时使用sortKey）
+    uint32_t dir;        // 所在目录在目录表中的下标
+    uint32_t id;         // 条目在当前列表中的编号（缓存的排序结果按编号记录顺序）
+    int32_t playCount;   // 启动次数（-1表示尚未查询）
+    uint8_t type;        // FileType
+    uint8_t flags;       // FileEntryFlags
+    uint64_t size;
+    int64_t mtime;       // 修改时间（纳秒，按大小/时间排序时才stat）
+
+    bool isDirectory() const { return (flags & FILE_ENTRY_DIRECTORY) != 0; }
+    bool isParent() const { return (flags & FILE_ENTRY_PARENT) != 0; }
+    bool metadataPending() const { return (flags & FILE_ENTRY_METADATA_PENDING) != 0; }
+};
+
+// 一个目录列表（或ROM库搜索结果）：条目数组 + 目录表 + 字符串池
+// 重新生成列表只需要clear()，已分配的内存会被复用
+class FileListing {
+public:
+    static const uint32_t NO_STRING = 0xFFFFFFFF;
+
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    FileEntry& operator[](size_t index) { return entries[index]; }
+    const FileEntry& operator[](size_t index) const { return entries[index]; }
+
+    // 条目数组（排序和合并直接操作，字符串偏移不受影响）
+    std::vector<FileEntry>& getEntries() { return entries; }
+
+    // 清空条目、目录表和字符串池
+    void clear();
+
+    uint32_t addString(const char* str, size_t length);
+    uint32_t addString(const std::string& str) { return addString(str.data(), str.size()); }
+
+    // 返回的指针在下一次添加字符串之前有效
+    const char* getString(uint32_t offset) const { return &strings[offset]; }
+
+    uint32_t addDirectory(const std::string& path);
+    const char* getDirectory(uint32_t dir) const { return getString(dirs[dir]); }
+
+    // 添加条目：名称写入字符串池，排序键在这里计算一次
+    FileEntry& addEntry(uint32_t dir, const char* name, uint8_t flags, FileType type);
+
+    // 复制另一个列表中的条目（连同字符串），放入本列表的dir目录
+    FileEntry& addEntry(const FileListing& other, const FileEntry& entry, uint32_t dir);
+    void append(const FileListing& other, uint32_t dir);
+
+    const char* getName(const FileEntry& entry) const { return getString(entry.name); }
+    const char* getSortKey(const FileEntry& entry) const { return getString(entry.sortKey); }
+    const char* getTitleKey(const FileEntry& entry) const;
+
+    // 标题（没有标题时返回文件名）
+    const char* getTitle(const FileEntry& entry) const;
+    void setTitle(FileEntry& entry, const std::string& title);
+    // 只更新显示的标题，排序键不变（条目已按原来的键排在列表中时使用）
+    void setDisplayTitle(FileEntry& entry, const std::string& title);
+
+    std::string getPath(const FileEntry& entry) const;
+
+    // 字符串池和条目数组占用的内存（字节）
+    size_t getBytesUsed() const;
+
+private:
+    std::vector<FileEntry> entries;
+    std::vector<uint32_t> dirs;     // 目录路径在字符串池中的偏移
+    std::vector<char> strings;      // 以'\0'结尾的字符串依次存放
+};
@@ -0,0 +1,74 @@
+#include "fileTypes.h"
+#include <cstring>
+
+// 扩展名表（小写，不含'.'），添加新系统只需要在这里加一行
+static const struct {
+    const char* extension;
+    FileType type;
+} EXTENSION_TABLE[] = {
+    {"nds", FILE_TYPE_NDS}, {"dsi", FILE_TYPE_NDS}, {"ids", FILE_TYPE_NDS},
+    {"srl", FILE_TYPE_NDS}, {"app", FILE_TYPE_NDS}, {"argv", FILE_TYPE_NDS},
+    {"png", FILE_TYPE_PNG},
+    {"gba", FILE_TYPE_GBA}, {"agb", FILE_TYPE_GBA},
+    {"gb", FILE_TYPE_GB}, {"gbc", FILE_TYPE_GB}, {"sgb", FILE_TYPE_GB},
+    {"nes", FILE_TYPE_NES}, {"fds", FILE_TYPE_NES},
+    {"sfc", FILE_TYPE_SNES}, {"smc", FILE_TYPE_SNES}, {"snes", FILE_TYPE_SNES},
+    {"gen", FILE_TYPE_MD}, {"md", FILE_TYPE_MD}, {"smd", FILE_TYPE_MD},
+    {"sms", FILE_TYPE_SMS},
+    {"gg", FILE_TYPE_GG},
+    {"pce", FILE_TYPE_PCE},
+    {"a26", FILE_TYPE_A26},
+    {"ws", FILE_TYPE_WS}, {"wsc", FILE_TYPE_WS},
+    {"ngp", FILE_TYPE_NGP}, {"ngc", FILE_TYPE_NGP},
+};
+
+// 各类型的主题图标（下标为FileType）
+static const char* const TYPE_ICONS[FILE_TYPE_COUNT] = {
+    nullptr,            // OTHER
+    nullptr,            // DIRECTORY
+    nullptr,            // NDS：使用ROM自己的图标
+    nullptr,            // PNG
+    "grf/icon_gba",
+    "grf/icon_gb",
+    "grf/icon_nes",
+    "grf/icon_snes",
+    "grf/icon_md",
+    "grf/icon_sms",
+    "grf/icon_gg",
+    "grf/icon_pce",
+    "grf/icon_a26",
+    "grf/icon_ws",
+    "grf/icon_ngp",
+};
+
+// 表中最长的扩展名
+static const size_t MAX_EXTENSION_LENGTH = 4;
+
+FileType classifyFileName(const char* name) {
+    const char* dot = strrchr(name, '.');
+    if (!dot) {
+        return FILE_TYPE_OTHER;
+    }
+
+    // 扩展名转小写后复制到栈上的缓冲区
+    char extension[MAX_EXTENSION_LENGTH + 1];
+    size_t length = 0;
+    for (const char* c = dot + 1; *c; c++) {
+        if (length == MAX_EXTENSION_LENGTH) {
+            return FILE_TYPE_OTHER;
+        }
+        extension[length++] = (*c >= 'A' && *c <= 'Z') ? *c - 'A' + 'a' : *c;
+    }
+    extension[length] = '\0';
+
+    for (const auto& entry : EXTENSION_TABLE) {
+        if (strcmp(extension, entry.extension) == 0) {
+            return entry.type;
+        }
+    }
+    return FILE_TYPE_OTHER;
+}
+
+const char* getFileTypeIcon(FileType type) {
+    return type < FILE_TYPE_COUNT ? TYPE_ICONS[type] : nullptr;
+}
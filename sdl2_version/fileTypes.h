@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+// 文件类型（扫描时根据扩展名判断一次，保存在条目中，绘制时不再比较字符串）
+enum FileType : uint8_t {
+    FILE_TYPE_OTHER,
+    FILE_TYPE_DIRECTORY,
+    FILE_TYPE_NDS,
+    FILE_TYPE_PNG,
+    FILE_TYPE_GBA,
+    FILE_TYPE_GB,
+    FILE_TYPE_NES,
+    FILE_TYPE_SNES,
+    FILE_TYPE_MD,
+    FILE_TYPE_SMS,
+    FILE_TYPE_GG,
+    FILE_TYPE_PCE,
+    FILE_TYPE_A26,
+    FILE_TYPE_WS,
+    FILE_TYPE_NGP,
+    FILE_TYPE_COUNT
+};
+
+// 根据扩展名判断文件类型（查表，忽略大小写，不分配内存）
+FileType classifyFileName(const char* name);
+
+// 该类型在主题中的图标（相对主题目录，例如"grf/icon_gba"），没有专用图标时返回nullptr
+const char* getFileTypeIcon(FileType type);
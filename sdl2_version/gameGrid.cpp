@@ -1,5 +1,7 @@
 #include "gameGrid.h"
 #include "input.h"
+#include "fileBrowser.h"
+#include "ndsIconLoader.h"
 #include <SDL2/SDL.h>
 #include <cmath>
 
@@ -70,7 +72,7 @@ float GameGrid::getAnimatedScrollOffset() {
     return animatedScrollOffset;
 }
 
-void GameGrid::update() {
+void GameGrid::update(FileBrowser* browser) {
     // 平滑动画：使用线性插值从当前动画位置移动到目标位置
     const float animationSpeed = 0.3f;  // 动画速度（0-1之间，越大越快）
     float diff = targetScrollOffset - animatedScrollOffset;
@@ -83,34 +85,53 @@ void GameGrid::update() {
         animatedScrollOffset = targetScrollOffset;
     }
     
-    // 左右键：逐个移动
-    if (InputManager::isKeyDown(KEY_LEFT)) {
+    int previousIndex = selectedIndex;
+    
+    // 左右键：逐个移动（按住时连发并逐渐加速）
+    if (InputManager::isKeyDownRepeat(KEY_LEFT)) {
         if (selectedIndex > 0) {
             setSelectedIndex(selectedIndex - 1);
         }
     }
     
-    if (InputManager::isKeyDown(KEY_RIGHT)) {
+    if (InputManager::isKeyDownRepeat(KEY_RIGHT)) {
         if (maxItemsCount == 0 || selectedIndex < maxItemsCount - 1) {
             setSelectedIndex(selectedIndex + 1);
         }
     }
     
-    // L/R键（Q/W）：翻页
-    if (InputManager::isKeyDown(KEY_L)) {
-        // L键（Q）：向前翻一页（向左）
+    // L/R键（Q/W）：按一下翻页，按住后按首字母分组跳转
+    if (InputManager::isKeyDownRepeat(KEY_L)) {
+        // L键（Q）：向前（向左）
         int newIndex = selectedIndex - maxVisible;
+        if (InputManager::getRepeatCount(KEY_L) > 0 && browser) {
+            newIndex = browser->getLetterGroupStart(selectedIndex, -1);
+        }
         if (newIndex < 0) newIndex = 0;
         setSelectedIndex(newIndex);
     }
     
-    if (InputManager::isKeyDown(KEY_R)) {
-        // R键（W）：向后翻一页（向右）
+    if (InputManager::isKeyDownRepeat(KEY_R)) {
+        // R键（W）：向后（向右）
         int newIndex = selectedIndex + maxVisible;
+        if (InputManager::getRepeatCount(KEY_R) > 0 && browser) {
+            newIndex = browser->getLetterGroupStart(selectedIndex, 1);
+        }
         if (maxItemsCount > 0 && newIndex >= maxItemsCount) {
             newIndex = maxItemsCount - 1;
         }
         setSelectedIndex(newIndex);
     }
+    
+    // 连发移动时，之前排队的图标已经滚出屏幕，不再解码
+    if (selectedIndex != previousIndex && isFastScrolling()) {
+        NDSIconLoader::cancelQueuedRequests();
+    }
+}
+
+bool GameGrid::isFastScrolling() {
+    return InputManager::getRepeatCount(KEY_LEFT) > 0 || InputManager::getRepeatCount(KEY_RIGHT) > 0 ||
+           InputManager::getRepeatCount(KEY_UP) > 0 || InputManager::getRepeatCount(KEY_DOWN) > 0 ||
+           InputManager::getRepeatCount(KEY_L) > 0 || InputManager::getRepeatCount(KEY_R) > 0;
 }
 
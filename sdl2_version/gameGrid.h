@@ -1,13 +1,20 @@
 #pragma once
 
+class FileBrowser;
+
 class GameGrid {
 public:
     static int getSelectedIndex() { return selectedIndex; }
     static int getScrollOffset() { return scrollOffset; }
     static float getAnimatedScrollOffset();  // 获取动画后的滚动偏移
+    static bool isAnimating() { return animatedScrollOffset != targetScrollOffset; }  // 滚动动画进行中
     static void setSelectedIndex(int index);
     static void setMaxItems(int maxItems) { maxItemsCount = maxItems; }
-    static void update();
+    // 处理输入：左/右逐个移动，L/R翻页，按住L/R时按browser的首字母分组跳转（browser可以为空）
+    static void update(FileBrowser* browser);
+    
+    // 是否正在按住方向键或L/R连续滚动
+    static bool isFastScrolling();
     
 private:
     static int selectedIndex;
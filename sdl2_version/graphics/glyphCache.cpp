@@ -0,0 +1,177 @@
+#include "glyphCache.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+// 缓存文件格式：
+//   文件头：magic(8) + version(u32) + fontHash(u64) + count(u32)
+//   每条记录：slot(u8) + codepoint(u32) + advance(i16) + width(u16) + height(u16) + alpha(width*height)
+static const char CACHE_MAGIC[8] = {'T', 'W', 'L', 'G', 'L', 'Y', 'P', 'H'};
+static const uint32_t CACHE_VERSION = 1;
+
+// 最多保存的字形数（12号CJK字形约200字节，上限约1MB）
+static const size_t MAX_GLYPHS = 4096;
+// 字号槽数（与TextRenderer的小/中/大三种字号相同）和字形的最大宽高（文字图集一页的大小）
+static const int SLOT_COUNT = 3;
+static const int MAX_GLYPH_SIZE = 512;
+// 计算哈希时每段读取的字节数
+static const size_t HASH_SAMPLE_SIZE = 64 * 1024;
+
+std::string GlyphCache::cachePath = "glyphcache.bin";
+uint64_t GlyphCache::fontHash = 0;
+std::map<GlyphCache::GlyphKey, CachedGlyph> GlyphCache::entries;
+bool GlyphCache::dirty = false;
+
+void GlyphCache::init(const std::string& cacheFile) {
+    cachePath = cacheFile;
+    entries.clear();
+    fontHash = 0;
+    dirty = false;
+}
+
+void GlyphCache::cleanup() {
+    save();
+    entries.clear();
+    fontHash = 0;
+}
+
+void GlyphCache::open(uint64_t hash) {
+    if (hash == fontHash) return;
+    save();
+    entries.clear();
+    dirty = false;
+    fontHash = hash;
+    if (fontHash != 0) {
+        load();
+    }
+}
+
+void GlyphCache::load() {
+    FILE* fp = fopen(cachePath.c_str(), "rb");
+    if (!fp) {
+        return;  // 还没有缓存文件
+    }
+
+    char magic[8];
+    uint32_t version = 0;
+    uint64_t hash = 0;
+    uint32_t count = 0;
+    if (fread(magic, sizeof(magic), 1, fp) != 1 ||
+        memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 ||
+        fread(&version, 4, 1, fp) != 1 || version != CACHE_VERSION ||
+        fread(&hash, 8, 1, fp) != 1 ||
+        fread(&count, 4, 1, fp) != 1) {
+        std::cerr << "字形缓存格式无效，忽略: " << cachePath << std::endl;
+        fclose(fp);
+        return;
+    }
+    if (hash != fontHash) {
+        // 字体已更换，旧字形全部作废（保存新字形时覆盖）
+        fclose(fp);
+        return;
+    }
+
+    // 记录中的字号槽和宽高必须有效：损坏的文件可能让宽高达到65535（单个字形分配4GB），
+    // 读到无效或不完整的记录时丢弃整个文件
+    bool valid = count <= MAX_GLYPHS;
+    for (uint32_t i = 0; valid && i < count; i++) {
+        uint8_t slot = 0;
+        uint32_t codepoint = 0;
+        CachedGlyph glyph;
+        valid = fread(&slot, 1, 1, fp) == 1 &&
+                fread(&codepoint, 4, 1, fp) == 1 &&
+                fread(&glyph.advance, 2, 1, fp) == 1 &&
+                fread(&glyph.width, 2, 1, fp) == 1 &&
+                fread(&glyph.height, 2, 1, fp) == 1 &&
+                slot < SLOT_COUNT &&
+                glyph.width <= MAX_GLYPH_SIZE && glyph.height <= MAX_GLYPH_SIZE;
+        if (!valid) break;
+        glyph.alpha.resize((size_t)glyph.width * glyph.height);
+        valid = glyph.alpha.empty() || fread(glyph.alpha.data(), glyph.alpha.size(), 1, fp) == 1;
+        if (valid) {
+            entries[GlyphKey(slot, codepoint)] = std::move(glyph);
+        }
+    }
+
+    fclose(fp);
+    if (!valid) {
+        std::cerr << "字形缓存已损坏，删除: " << cachePath << std::endl;
+        entries.clear();
+        remove(cachePath.c_str());
+        return;
+    }
+    std::cout << "已加载字形缓存: " << entries.size() << " 个字形" << std::endl;
+}
+
+bool GlyphCache::save() {
+    if (!dirty || fontHash == 0) return true;
+
+    // 先写入临时文件再重命名，避免中途退出导致缓存损坏
+    std::string tmpPath = cachePath + ".tmp";
+    FILE* fp = fopen(tmpPath.c_str(), "wb");
+    if (!fp) {
+        std::cerr << "无法写入字形缓存: " << tmpPath << std::endl;
+        return false;
+    }
+
+    uint32_t count = entries.size();
+    bool ok = fwrite(CACHE_MAGIC, sizeof(CACHE_MAGIC), 1, fp) == 1 &&
+              fwrite(&CACHE_VERSION, 4, 1, fp) == 1 &&
+              fwrite(&fontHash, 8, 1, fp) == 1 &&
+              fwrite(&count, 4, 1, fp) == 1;
+
+    for (const auto& pair : entries) {
+        if (!ok) break;
+        uint8_t slot = pair.first.first;
+        uint32_t codepoint = pair.first.second;
+        const CachedGlyph& glyph = pair.second;
+        ok = fwrite(&slot, 1, 1, fp) == 1 &&
+             fwrite(&codepoint, 4, 1, fp) == 1 &&
+             fwrite(&glyph.advance, 2, 1, fp) == 1 &&
+             fwrite(&glyph.width, 2, 1, fp) == 1 &&
+             fwrite(&glyph.height, 2, 1, fp) == 1 &&
+             fwrite(glyph.alpha.data(), 1, glyph.alpha.size(), fp) == glyph.alpha.size();
+    }
+
+    if (fclose(fp) != 0) ok = false;
+    if (!ok || rename(tmpPath.c_str(), cachePath.c_str()) != 0) {
+        std::cerr << "保存字形缓存失败: " << cachePath << std::endl;
+        remove(tmpPath.c_str());
+        return false;
+    }
+
+    dirty = false;
+    return true;
+}
+
+const CachedGlyph* GlyphCache::lookup(int slot, uint32_t codepoint) {
+    if (fontHash == 0) return nullptr;
+    auto it = entries.find(GlyphKey(slot, codepoint));
+    return it != entries.end() ? &it->second : nullptr;
+}
+
+void GlyphCache::store(int slot, uint32_t codepoint, const CachedGlyph& glyph) {
+    if (fontHash == 0 || entries.size() >= MAX_GLYPHS) return;
+    if (slot < 0 || slot >= SLOT_COUNT || glyph.width > MAX_GLYPH_SIZE || glyph.height > MAX_GLYPH_SIZE) return;
+    entries[GlyphKey(slot, codepoint)] = glyph;
+    dirty = true;
+}
+
+uint64_t GlyphCache::hashFontData(const uint8_t* data, size_t size) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (int i = 0; i < 8; i++) {
+        hash = (hash ^ ((uint64_t)size >> (i * 8) & 0xFF)) * 1099511628211ULL;
+    }
+
+    size_t sampleSize = std::min(size, HASH_SAMPLE_SIZE);
+    const size_t starts[3] = {0, (size - sampleSize) / 2, size - sampleSize};
+    for (size_t start : starts) {
+        for (size_t i = start; i < start + sampleSize; i++) {
+            hash = (hash ^ data[i]) * 1099511628211ULL;
+        }
+    }
+    // 0表示不使用缓存
+    return hash != 0 ? hash : 1;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstddef>
+
+// 预光栅化字形（白色字形，只保存alpha）
+struct CachedGlyph {
+    int16_t advance;
+    uint16_t width;
+    uint16_t height;
+    std::vector<uint8_t> alpha;   // width*height，按行存放
+};
+
+// 字形磁盘缓存：保存用过的TTF字形，下次启动时不必再光栅化（CJK字体的光栅化很慢）
+// 以字体文件哈希为键，字体换了整个缓存作废；只在主线程使用
+class GlyphCache {
+public:
+    static void init(const std::string& cacheFile = "glyphcache.bin");
+    static void cleanup();
+
+    // 切换到与字体文件匹配的缓存（哈希与文件中的不同时丢弃旧内容），hash为0表示不使用缓存
+    static void open(uint64_t fontHash);
+
+    // 按（字号槽, 字符）查找
+    static const CachedGlyph* lookup(int slot, uint32_t codepoint);
+    static void store(int slot, uint32_t codepoint, const CachedGlyph& glyph);
+
+    // 保存到磁盘（仅在有修改时写入）
+    static bool save();
+
+    // 字体文件哈希：文件大小和开头、中间、结尾各一段的FNV-1a（不读整个大字体文件）
+    static uint64_t hashFontData(const uint8_t* data, size_t size);
+
+private:
+    typedef std::pair<int, uint32_t> GlyphKey;
+    static std::string cachePath;
+    static uint64_t fontHash;
+    static std::map<GlyphKey, CachedGlyph> entries;
+    static bool dirty;
+
+    static void load();
+};
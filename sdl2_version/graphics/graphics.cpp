@@ -1,9 +1,16 @@
 #include "graphics.h"
 #include "textRenderer.h"
+#include "glyphCache.h"
 #include "../dsiUI.h"
 #include "../gameGrid.h"
 #include "../fileBrowser.h"
 #include "../input.h"
+#include "../ndsIconLoader.h"
+#include "../resourceManager.h"
+#include "../memoryPressure.h"
+#include "../libraryIndex.h"
+#include "../listView.h"
+#include "../dirtyTracker.h"
 extern FileBrowser* g_fileBrowser;
 #include <iostream>
 #include <cstring>
@@ -34,7 +41,8 @@ bool graphicsInit() {
         return false;
     }
 
-    // 初始化文本渲染器
+    // 初始化文本渲染器（字形磁盘缓存在加载字体时按字体哈希打开，退出时由TextRenderer::cleanup保存）
+    GlyphCache::init();
     TextRenderer::init(g_renderer);
     
     // 初始化DSi UI
@@ -66,6 +74,7 @@ bool graphicsInit() {
 }
 
 void graphicsCleanup() {
+    ListView::cleanup();
     DSiUI::cleanup();
     TextRenderer::cleanup();
     
@@ -224,6 +233,55 @@ void updateFrame(bool updateFrame) {
         lastTimeUpdate = currentTime;
         // 日期和时间会在renderFrame中重新绘制
     }
+    
+    // 合并后台目录扫描的结果和目录变化，网格保持选中同一个条目
+    // （文件浏览器未打开时，由网格决定选中项）
+    if (g_fileBrowser) {
+        bool gridMode = !g_fileBrowser->isActive();
+        if (gridMode) {
+            g_fileBrowser->setSelectedIndex(GameGrid::getSelectedIndex());
+        }
+        if (g_fileBrowser->pollChanges()) {
+            DirtyTracker::invalidate();
+            if (gridMode) {
+                GameGrid::setMaxItems(g_fileBrowser->getFiles().size());
+                GameGrid::setSelectedIndex(g_fileBrowser->getSelectedIndex());
+            }
+        }
+        
+        // ROM库索引在后台更新完成：刷新搜索结果
+        if (LibraryIndex::poll() && g_fileBrowser->isLibraryMode()) {
+            DirtyTracker::invalidate();
+            g_fileBrowser->refreshLibraryResults();
+            if (gridMode) {
+                GameGrid::setMaxItems(g_fileBrowser->getFiles().size());
+                GameGrid::setSelectedIndex(g_fileBrowser->getSelectedIndex());
+            }
+        }
+    }
+    
+    // 为网格（或列表）中可见及即将滚动进来的条目读取标题
+    if (g_fileBrowser) {
+        if (ListView::isEnabled()) {
+            int firstRow = ListView::getFirstVisible();
+            g_fileBrowser->ensureMetadata(firstRow - 2, firstRow + ListView::getVisibleRows() + 2);
+        } else {
+            int scrollOffset = GameGrid::getScrollOffset();
+            g_fileBrowser->ensureMetadata(scrollOffset - 2, scrollOffset + 5 + 2);
+        }
+    }
+    
+    // 上传后台解码完成的NDS图标（每帧数量有限）
+    NDSIconLoader::processCompletedIcons(4);
+    
+    // 系统内存紧张时释放缓存
+    if (MemoryPressure::poll()) {
+        std::cout << "检测到内存压力，释放纹理缓存" << std::endl;
+        NDSIconLoader::trim();
+        BannerCache::trim();
+        ResourceManager::trim(ResourceManager::getStats().budgetBytes / 2);
+        DirtyTracker::invalidate();
+    }
 }
 
 void renderFrame() {
@@ -231,6 +289,9 @@ void renderFrame() {
         return;
     }
 
+    // 文本纹理缓存按帧计算使用次数和淘汰
+    TextRenderer::nextFrame();
+    
     // 清除屏幕
     SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 255);
     SDL_RenderClear(g_renderer);
@@ -260,7 +321,7 @@ void renderFrame() {
     // L/R按钮将在后面根据实际按键状态绘制
     
     // 获取文件列表（如果文件浏览器已初始化）
-    const std::vector<FileEntry>* fileList = nullptr;
+    const FileListing* fileList = nullptr;
     int totalItems = 0;
     if (g_fileBrowser) {
         fileList = &g_fileBrowser->getFiles();
@@ -280,7 +341,12 @@ void renderFrame() {
     bool leftActive = InputManager::isKeyHeld(KEY_L);
     bool rightActive = InputManager::isKeyHeld(KEY_R);
     
-    DSiUI::drawGameGrid(selectedGame, scrollOffset, fileList);
+    // 列表视图只绘制可见的行（大目录），否则绘制DSi图标网格
+    if (ListView::isEnabled() && g_fileBrowser) {
+        ListView::render(g_fileBrowser, selectedGame);
+    } else {
+        DSiUI::drawGameGrid(selectedGame, scrollOffset, fileList);
+    }
     //DSiUI::drawStartBorder(true);
     
     // 更新L/R按钮显示状态
@@ -288,8 +354,18 @@ void renderFrame() {
     
     // 绘制提示文本（下屏底部：y坐标+192）
     SDL_Color hintColor = {0, 0, 0, 255};
-    TextRenderer::drawTextCentered(0, 250 + 192, 256, "Press START to open menu", hintColor, 12);
-    TextRenderer::drawTextCentered(0, 265 + 192, 256, "Press ESC to exit", hintColor, 12);
+    if (g_fileBrowser && g_fileBrowser->isLibraryMode()) {
+        // ROM库模式：显示搜索词和当前可输入的字符
+        std::string query = "搜索: " + g_fileBrowser->getLibraryQuery() + "_  [" + g_fileBrowser->getLibraryLetter() + "]";
+        if (LibraryIndex::isUpdating()) {
+            query += " ...";
+        }
+        TextRenderer::drawTextCentered(0, 250 + 192, 256, query, hintColor, 12);
+        TextRenderer::drawTextCentered(0, 265 + 192, 256, "上/下:选字  Y:输入  X:删除  SELECT:返回", hintColor, 12);
+    } else {
+        TextRenderer::drawTextCentered(0, 250 + 192, 256, "Press START to open menu", hintColor, 12);
+        TextRenderer::drawTextCentered(0, 265 + 192, 256, "Press ESC to exit", hintColor, 12);
+    }
 }
 
 bool screenFadedIn() {
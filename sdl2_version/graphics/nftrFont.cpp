@@ -0,0 +1,233 @@
+#include "nftrFont.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+// 链表形式的段（CWDH/CMAP）最多跟随的个数，防止损坏的文件造成死循环
+static const int MAX_LINKED_SECTIONS = 1024;
+
+// DSi默认字体调色板（与主题theme.ini中的默认值相同）
+static const uint16_t DEFAULT_PALETTE[4] = {0x0000, 0xDEF7, 0xC631, 0xA108};
+
+NFTRFont::NFTRFont() : lineHeight(0), replacementGlyph(0), defaultMetrics{0, 0, 0},
+                       glyphOffset(0), cellWidth(0), cellHeight(0), glyphBytes(0),
+                       bitsPerPixel(0), glyphCount(0) {
+    setPalette(DEFAULT_PALETTE);
+}
+
+uint16_t NFTRFont::read16(size_t offset) const {
+    if (offset + 2 > data.size()) return 0;
+    return data[offset] | (data[offset + 1] << 8);
+}
+
+uint32_t NFTRFont::read32(size_t offset) const {
+    if (offset + 4 > data.size()) return 0;
+    return data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) | ((uint32_t)data[offset + 3] << 24);
+}
+
+bool NFTRFont::load(const std::string& path) {
+    unload();
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    // 文件头："RTFN"，之后是FINF段（段标识在文件中按字节倒序存放）
+    size_t finf = read16(0x0C);
+    if (data.size() < 0x10 || memcmp(data.data(), "RTFN", 4) != 0 ||
+        finf + 0x1C > data.size() || memcmp(data.data() + finf, "FNIF", 4) != 0) {
+        std::cerr << "无效的NFTR字体: " << path << std::endl;
+        unload();
+        return false;
+    }
+
+    // FINF中的偏移指向各段的数据（段头之后）
+    size_t info = finf + 8;
+    lineHeight = data[info + 1];
+    replacementGlyph = read16(info + 2);
+    defaultMetrics.left = (int8_t)data[info + 4];
+    defaultMetrics.width = data[info + 5];
+    defaultMetrics.advance = data[info + 6];
+
+    if (!parseGlyphs(read32(info + 8))) {
+        std::cerr << "NFTR字体缺少字形数据: " << path << std::endl;
+        unload();
+        return false;
+    }
+    parseWidths(read32(info + 12));
+    parseCharMaps(read32(info + 16));
+
+    // 旧版本字体没有行距，使用单元格高度
+    if (lineHeight == 0) {
+        lineHeight = cellHeight;
+    }
+    if (replacementGlyph >= glyphCount) {
+        replacementGlyph = 0;
+    }
+    return true;
+}
+
+void NFTRFont::unload() {
+    data.clear();
+    data.shrink_to_fit();
+    metrics.clear();
+    charMap.clear();
+    glyphCount = 0;
+}
+
+bool NFTRFont::parseGlyphs(size_t offset) {
+    if (offset < 8 || offset + 8 > data.size()) {
+        return false;
+    }
+    cellWidth = data[offset];
+    cellHeight = data[offset + 1];
+    glyphBytes = read16(offset + 2);
+    bitsPerPixel = data[offset + 6];
+    if (cellWidth == 0 || cellHeight == 0 || glyphBytes == 0 ||
+        bitsPerPixel == 0 || bitsPerPixel > 8 ||
+        glyphBytes * 8 < cellWidth * cellHeight * bitsPerPixel) {
+        return false;
+    }
+
+    // 段大小包含段头（8字节）和CGLP自己的8字节字段
+    glyphOffset = offset + 8;
+    size_t sectionEnd = std::min(data.size(), offset - 8 + (size_t)read32(offset - 4));
+    glyphCount = sectionEnd > glyphOffset ? (int)((sectionEnd - glyphOffset) / glyphBytes) : 0;
+    return glyphCount > 0;
+}
+
+void NFTRFont::parseWidths(size_t offset) {
+    metrics.assign(glyphCount, defaultMetrics);
+    for (int i = 0; i < MAX_LINKED_SECTIONS && offset != 0 && offset + 8 <= data.size(); i++) {
+        int first = read16(offset);
+        int last = read16(offset + 2);
+        size_t entry = offset + 8;
+        for (int index = first; index <= last && index < glyphCount && entry + 3 <= data.size(); index++, entry += 3) {
+            metrics[index].left = (int8_t)data[entry];
+            metrics[index].width = data[entry + 1];
+            metrics[index].advance = data[entry + 2];
+        }
+        offset = read32(offset + 4);
+    }
+}
+
+void NFTRFont::parseCharMaps(size_t offset) {
+    for (int i = 0; i < MAX_LINKED_SECTIONS && offset != 0 && offset + 12 <= data.size(); i++) {
+        uint32_t first = read16(offset);
+        uint32_t last = read16(offset + 2);
+        uint16_t type = read16(offset + 4);
+        size_t table = offset + 12;
+
+        if (type == 0) {
+            // 连续映射：字形编号 = 起始编号 + (字符 - 起始字符)
+            uint16_t base = read16(table);
+            for (uint32_t c = first; c <= last; c++) {
+                charMap[c] = base + (c - first);
+            }
+        } else if (type == 1) {
+            // 表映射：每个字符一个字形编号，0xFFFF表示没有
+            for (uint32_t c = first; c <= last && table + 2 <= data.size(); c++, table += 2) {
+                uint16_t index = read16(table);
+                if (index != 0xFFFF) {
+                    charMap[c] = index;
+                }
+            }
+        } else if (type == 2) {
+            // 稀疏映射：(字符, 字形编号)对
+            int count = read16(table);
+            table += 2;
+            for (int n = 0; n < count && table + 4 <= data.size(); n++, table += 4) {
+                charMap[read16(table)] = read16(table + 2);
+            }
+        }
+        offset = read32(offset + 8);
+    }
+}
+
+int NFTRFont::findGlyph(uint32_t codepoint) const {
+    auto it = charMap.find(codepoint);
+    if (it == charMap.end() || it->second >= glyphCount) {
+        return -1;
+    }
+    return it->second;
+}
+
+NFTRFont::Metrics NFTRFont::getMetrics(int index) const {
+    if (index < 0 || index >= (int)metrics.size()) {
+        return defaultMetrics;
+    }
+    return metrics[index];
+}
+
+bool NFTRFont::rasterize(int index, std::vector<uint32_t>& pixels, int& width) const {
+    if (index < 0 || index >= glyphCount) {
+        return false;
+    }
+    width = std::min(getMetrics(index).width, cellWidth);
+    if (width <= 0) {
+        return false;
+    }
+
+    // 像素按行连续存放，每像素bitsPerPixel位，高位在前
+    const uint8_t* bits = data.data() + glyphOffset + (size_t)index * glyphBytes;
+    int maxValue = (1 << bitsPerPixel) - 1;
+    bool visible = false;
+    pixels.assign((size_t)width * cellHeight, 0);
+    for (int y = 0; y < cellHeight; y++) {
+        for (int x = 0; x < width; x++) {
+            int bit = (y * cellWidth + x) * bitsPerPixel;
+            int value = (bits[bit / 8] << (bit % 8) & 0xFF) >> (8 - bitsPerPixel);
+            if (value == 0) continue;
+            // 其他位深的像素值按比例对应到4色调色板
+            int paletteIndex = bitsPerPixel == 2 ? value : std::max(1, value * 3 / maxValue);
+            pixels[y * width + x] = ((uint32_t)paletteAlpha[paletteIndex] << 24) | 0xFFFFFF;
+            visible = true;
+        }
+    }
+    return visible;
+}
+
+void NFTRFont::setPalette(const uint16_t palette[4]) {
+    // 调色板第一项是背景（透明），其余三项是由浅到深的文字颜色；
+    // 文字颜色由调用者决定，这里把每项相对最深一项的深浅换算成alpha，保留主题的抗锯齿层次
+    int darkness[4];
+    int darkest = 0;
+    for (int i = 1; i < 4; i++) {
+        int r = palette[i] & 0x1F;
+        int g = (palette[i] >> 5) & 0x1F;
+        int b = (palette[i] >> 10) & 0x1F;
+        darkness[i] = 31 * 1000 - (r * 299 + g * 587 + b * 114);
+        darkest = std::max(darkest, darkness[i]);
+    }
+    paletteAlpha[0] = 0;
+    for (int i = 1; i < 4; i++) {
+        paletteAlpha[i] = darkest > 0 ? darkness[i] * 255 / darkest : i * 85;
+    }
+}
+
+bool NFTRFont::readThemePalette(const std::string& iniPath, uint16_t palette[4]) {
+    std::ifstream file(iniPath);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    bool found = false;
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t pos = line.find('=');
+        if (pos == std::string::npos) continue;
+        std::string key = line.substr(0, pos);
+        key.erase(key.find_last_not_of(" \t") + 1);
+        key.erase(0, key.find_first_not_of(" \t"));
+        if (key.size() != 12 || key.compare(0, 11, "FontPalette") != 0 || key[11] < '1' || key[11] > '4') {
+            continue;
+        }
+        palette[key[11] - '1'] = (uint16_t)strtoul(line.c_str() + pos + 1, nullptr, 0);
+        found = true;
+    }
+    return found;
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+// DS系统字体（NFTR，主题font目录中的small.nftr等）
+// 解析FINF/CGLP/CWDH/CMAP四个段；字形按需转换成ARGB像素，由TextRenderer放进字形图集
+class NFTRFont {
+public:
+    struct Metrics {
+        int left;       // 左侧留白
+        int width;      // 字形宽度（位图中实际使用的列数）
+        int advance;    // 前进宽度
+    };
+
+    NFTRFont();
+
+    bool load(const std::string& path);
+    void unload();
+    bool isLoaded() const { return !data.empty(); }
+
+    int getLineHeight() const { return lineHeight; }
+    int getCellHeight() const { return cellHeight; }
+
+    // 字符对应的字形编号，字体中没有时返回-1
+    int findGlyph(uint32_t codepoint) const;
+    // 字体指定的替代字形（用于字体中没有的字符）
+    int getReplacementGlyph() const { return replacementGlyph; }
+    Metrics getMetrics(int index) const;
+
+    // 把字形转换成白色ARGB8888像素（宽度为字形宽度，高度为单元格高度），
+    // alpha取自调色板，绘制时再调制颜色；字形没有像素时返回false
+    bool rasterize(int index, std::vector<uint32_t>& pixels, int& width) const;
+
+    // 设置字体调色板（RGB15，对应theme.ini的FontPalette1..4，第一项为背景）
+    void setPalette(const uint16_t palette[4]);
+    // 从theme.ini读取FontPalette1..4，缺少的项保持原值
+    static bool readThemePalette(const std::string& iniPath, uint16_t palette[4]);
+
+private:
+    std::vector<uint8_t> data;
+    int lineHeight;
+    int replacementGlyph;
+    Metrics defaultMetrics;
+
+    // CGLP：字形位图
+    size_t glyphOffset;
+    int cellWidth, cellHeight;
+    int glyphBytes;
+    int bitsPerPixel;
+    int glyphCount;
+
+    std::vector<Metrics> metrics;            // CWDH，按字形编号
+    std::map<uint32_t, uint16_t> charMap;    // CMAP，字符到字形编号
+
+    uint8_t paletteAlpha[4];                 // 像素值对应的alpha
+
+    uint16_t read16(size_t offset) const;
+    uint32_t read32(size_t offset) const;
+    bool parseGlyphs(size_t offset);
+    void parseWidths(size_t offset);
+    void parseCharMaps(size_t offset);
+};
@@ -1,28 +1,136 @@
 #include "textRenderer.h"
+#include "glyphCache.h"
+#include "../resourceManager.h"
 #include <iostream>
 #include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 SDL_Renderer* TextRenderer::renderer = nullptr;
 TTF_Font* TextRenderer::smallFont = nullptr;
 TTF_Font* TextRenderer::mediumFont = nullptr;
 TTF_Font* TextRenderer::largeFont = nullptr;
 bool TextRenderer::fontsLoaded = false;
+bool TextRenderer::fontsTried = false;
+const uint8_t* TextRenderer::fontData = nullptr;
+size_t TextRenderer::fontDataSize = 0;
+FontBackend TextRenderer::backend = FONT_BACKEND_TTF;
+NFTRFont TextRenderer::nftrFont;
+bool TextRenderer::nftrTried = false;
+TextRenderer::GlyphTable TextRenderer::glyphTables[FONT_SLOT_COUNT];
+std::vector<SDL_Texture*> TextRenderer::atlasPages;
+int TextRenderer::shelfX = 0;
+int TextRenderer::shelfY = 0;
+int TextRenderer::shelfHeight = 0;
+std::map<TextRenderer::StringKey, TextRenderer::CachedString> TextRenderer::stringCache;
+std::list<TextRenderer::StringKey> TextRenderer::stringLru;
+size_t TextRenderer::stringBytes = 0;
+size_t TextRenderer::stringBudget = 1024 * 1024;
+uint32_t TextRenderer::frameCounter = 0;
+
+// 图集页大小和最多页数（12号字一页约可放2000个字形，超过上限时清空重建）
+static const int ATLAS_PAGE_SIZE = 512;
+static const size_t MAX_ATLAS_PAGES = 4;
+static const int8_t KERNING_UNKNOWN = -128;
+
+// 字符串缓存：超过这么多帧未使用的条目被淘汰（约5秒），以及最多条目数（只测量过宽度的条目也计算在内）
+static const uint32_t STRING_MAX_AGE = 300;
+static const size_t MAX_STRINGS = 1024;
+
+// 各字号槽对应的TTF字号（NFTR后端只使用第一个槽补字）
+static const int SLOT_FONT_SIZES[] = {12, 16, 20};
+
+static uint64_t hashString(const std::string& text) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+        hash = (hash ^ c) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// 解码一个UTF-8字符并前移指针（无效字节按单字节处理）
+static uint32_t decodeUTF8(const char*& p) {
+    unsigned char c = *p++;
+    if (c < 0x80) return c;
+    int extra;
+    uint32_t codepoint;
+    if ((c & 0xE0) == 0xC0) { extra = 1; codepoint = c & 0x1F; }
+    else if ((c & 0xF0) == 0xE0) { extra = 2; codepoint = c & 0x0F; }
+    else if ((c & 0xF8) == 0xF0) { extra = 3; codepoint = c & 0x07; }
+    else return '?';
+    for (int i = 0; i < extra; i++) {
+        if (((unsigned char)*p & 0xC0) != 0x80) return '?';
+        codepoint = (codepoint << 6) | (*p++ & 0x3F);
+    }
+    return codepoint;
+}
 
 void TextRenderer::init(SDL_Renderer* renderer) {
     TextRenderer::renderer = renderer;
     
-    // 初始化SDL_ttf
-    if (TTF_Init() == -1) {
-        std::cerr << "TTF_Init失败: " << TTF_GetError() << std::endl;
-        // 如果TTF初始化失败，继续使用简单渲染
-        return;
+    // 字体在第一次绘制时加载：设置读取之后才知道使用哪个后端
+    clearGlyphs();
+}
+
+void TextRenderer::setBackend(FontBackend newBackend) {
+    if (newBackend == backend) return;
+    
+    // 字形和整串纹理都来自原来的字体，全部丢弃
+    clearStrings();
+    clearGlyphs();
+    backend = newBackend;
+    nftrTried = false;
+}
+
+bool TextRenderer::loadNFTR() {
+    if (nftrTried) {
+        return nftrFont.isLoaded();
     }
+    nftrTried = true;
     
+    std::string themePath = ResourceManager::getThemePath();
+    std::string fontPath = themePath + "/font/small.nftr";
+    if (!nftrFont.load(fontPath)) {
+        std::cerr << "警告: 无法加载主题字体 " << fontPath << "，改用TTF字体" << std::endl;
+        return false;
+    }
+    
+    // 字形的深浅层次使用主题的字体调色板
+    uint16_t palette[4] = {0x0000, 0xDEF7, 0xC631, 0xA108};
+    NFTRFont::readThemePalette(themePath + "/theme.ini", palette);
+    nftrFont.setPalette(palette);
+    std::cout << "使用主题字体: " << fontPath << std::endl;
+    return true;
+}
+
+bool TextRenderer::prepareFont(int size, TTF_Font*& font) {
+    font = nullptr;
+    if (backend == FONT_BACKEND_NFTR && loadNFTR()) {
+        return true;
+    }
     loadFonts();
+    font = getFont(size);
+    return font != nullptr;
+}
+
+int TextRenderer::getLineHeight(TTF_Font* font) {
+    return font ? TTF_FontHeight(font) : nftrFont.getLineHeight();
 }
 
 void TextRenderer::loadFonts() {
-    if (fontsLoaded) return;
+    if (fontsLoaded || fontsTried) return;
+    fontsTried = true;
+    
+    // 初始化SDL_ttf
+    if (!TTF_WasInit() && TTF_Init() == -1) {
+        std::cerr << "TTF_Init失败: " << TTF_GetError() << std::endl;
+        // 如果TTF初始化失败，继续使用简单渲染
+        return;
+    }
     
     // 尝试加载支持中文的系统字体
     const char* fontPaths[] = {
@@ -60,21 +168,62 @@ void TextRenderer::loadFonts() {
         return;
     }
     
+    // 字体文件只映射一次，三种字号共用同一份数据（CJK字体有十几MB，不再读取三次）
+    mapFontFile(fontPath);
+    
     // 加载不同大小的字体（增大字体以提高清晰度）
-    smallFont = TTF_OpenFont(fontPath, 12);
-    mediumFont = TTF_OpenFont(fontPath, 16);
-    largeFont = TTF_OpenFont(fontPath, 20);
+    smallFont = openFont(fontPath, 12);
+    mediumFont = openFont(fontPath, 16);
+    largeFont = openFont(fontPath, 20);
     
     if (!smallFont) smallFont = mediumFont;
     if (!mediumFont) mediumFont = largeFont;
     if (!largeFont) {
         std::cerr << "警告: 无法加载字体，使用简单渲染" << std::endl;
+        freeFonts();
+        fontsTried = true;
         return;
     }
     
+    // 与这个字体文件对应的预光栅化字形（映射失败时无法计算哈希，不使用磁盘缓存）
+    GlyphCache::open(fontData ? GlyphCache::hashFontData(fontData, fontDataSize) : 0);
     fontsLoaded = true;
 }
 
+void TextRenderer::mapFontFile(const char* path) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            fontData = (const uint8_t*)addr;
+            fontDataSize = st.st_size;
+        }
+    }
+    // 映射建立后不再需要文件描述符
+    close(fd);
+}
+
+void TextRenderer::unmapFontFile() {
+    if (fontData) {
+        munmap((void*)fontData, fontDataSize);
+        fontData = nullptr;
+        fontDataSize = 0;
+    }
+}
+
+TTF_Font* TextRenderer::openFont(const char* path, int size) {
+    if (!fontData) {
+        // 映射失败时由SDL_ttf自己打开文件
+        return TTF_OpenFont(path, size);
+    }
+    SDL_RWops* rw = SDL_RWFromConstMem(fontData, (int)fontDataSize);
+    return rw ? TTF_OpenFontRW(rw, 1, size) : nullptr;
+}
+
 void TextRenderer::freeFonts() {
     if (smallFont && smallFont != mediumFont && smallFont != largeFont) {
         TTF_CloseFont(smallFont);
@@ -89,14 +238,229 @@ void TextRenderer::freeFonts() {
     mediumFont = nullptr;
     largeFont = nullptr;
     fontsLoaded = false;
+    fontsTried = false;
+    // 字体关闭之后才能解除映射
+    unmapFontFile();
 }
 
 void TextRenderer::cleanup() {
+    clearStrings();
+    clearGlyphs();
     freeFonts();
-    TTF_Quit();
+    GlyphCache::cleanup();
+    nftrFont.unload();
+    nftrTried = false;
+    if (TTF_WasInit()) {
+        TTF_Quit();
+    }
     TextRenderer::renderer = nullptr;
 }
 
+int TextRenderer::getFontSlot(int size) {
+    // 主题的NFTR字体只有一种字号（small.nftr），所有字号共用第一个字形表，
+    // 同一个字形在图集中只保存一份（缺字用12号TTF字体补上，与NFTR的行高接近）
+    if (useNFTR()) return 0;
+    // 与getFont的字号划分一致
+    if (size <= 12) return 0;
+    if (size <= 16) return 1;
+    return 2;
+}
+
+void TextRenderer::clearGlyphs() {
+    for (SDL_Texture* page : atlasPages) {
+        SDL_DestroyTexture(page);
+    }
+    atlasPages.clear();
+    shelfX = shelfY = shelfHeight = 0;
+    for (GlyphTable& table : glyphTables) {
+        for (Glyph& glyph : table.ascii) {
+            glyph.loaded = false;
+        }
+        table.others.clear();
+        memset(table.kerning, KERNING_UNKNOWN, sizeof(table.kerning));
+    }
+}
+
+bool TextRenderer::addToAtlas(SDL_Surface* surface, Glyph& glyph) {
+    int w = surface->w, h = surface->h;
+    if (w > ATLAS_PAGE_SIZE || h > ATLAS_PAGE_SIZE) {
+        return false;
+    }
+    
+    // 按行装箱：当前行放不下就换行，当前页放不下就新建一页
+    if (shelfX + w > ATLAS_PAGE_SIZE) {
+        shelfX = 0;
+        shelfY += shelfHeight;
+        shelfHeight = 0;
+    }
+    if (atlasPages.empty() || shelfY + h > ATLAS_PAGE_SIZE) {
+        if (atlasPages.size() >= MAX_ATLAS_PAGES) {
+            // 图集已满：全部清空，之后按需重新光栅化
+            clearGlyphs();
+        }
+        SDL_Texture* page = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC,
+                                              ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE);
+        if (!page) {
+            std::cerr << "无法创建字形图集: " << SDL_GetError() << std::endl;
+            return false;
+        }
+        SDL_SetTextureBlendMode(page, SDL_BLENDMODE_BLEND);
+        // 新页先清成透明
+        std::vector<uint32_t> clear(ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE, 0);
+        SDL_UpdateTexture(page, nullptr, clear.data(), ATLAS_PAGE_SIZE * 4);
+        atlasPages.push_back(page);
+        shelfX = shelfY = shelfHeight = 0;
+    }
+    
+    SDL_Surface* converted = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+    if (!converted) {
+        return false;
+    }
+    glyph.rect = {shelfX, shelfY, w, h};
+    glyph.page = atlasPages.size() - 1;
+    SDL_UpdateTexture(atlasPages.back(), &glyph.rect, converted->pixels, converted->pitch);
+    SDL_FreeSurface(converted);
+    
+    shelfX += w;
+    if (h > shelfHeight) shelfHeight = h;
+    return true;
+}
+
+const TextRenderer::Glyph& TextRenderer::getGlyph(int slot, TTF_Font* font, uint32_t codepoint) {
+    // SDL_ttf的16位接口只支持BMP字符
+    if (codepoint > 0xFFFF) {
+        codepoint = '?';
+    }
+    GlyphTable& table = glyphTables[slot];
+    if (codepoint < 128) {
+        if (table.ascii[codepoint].loaded) {
+            return table.ascii[codepoint];
+        }
+    } else {
+        auto it = table.others.find(codepoint);
+        if (it != table.others.end()) {
+            return it->second;
+        }
+    }
+    
+    Glyph glyph;
+    glyph.loaded = true;
+    glyph.page = -1;
+    glyph.rect = {0, 0, 0, 0};
+    glyph.offsetX = 0;
+    glyph.offsetY = 0;
+    
+    if (useNFTR()) {
+        int index = nftrFont.findGlyph(codepoint);
+        if (index < 0) {
+            // 主题字体里没有的字符（例如汉字）用同字号的TTF字体补上，这时才加载TTF字体
+            loadFonts();
+            font = getFont(SLOT_FONT_SIZES[slot]);
+            if (font) {
+                glyph.offsetY = (nftrFont.getLineHeight() - TTF_FontHeight(font)) / 2;
+            } else {
+                index = nftrFont.getReplacementGlyph();
+            }
+        }
+        if (index >= 0) {
+            rasterizeNFTRGlyph(index, glyph);
+            Glyph& stored = codepoint < 128 ? table.ascii[codepoint] : table.others[codepoint];
+            stored = glyph;
+            return stored;
+        }
+    }
+    
+    rasterizeTTFGlyph(slot, font, codepoint, glyph);
+    
+    Glyph& stored = codepoint < 128 ? table.ascii[codepoint] : table.others[codepoint];
+    stored = glyph;
+    return stored;
+}
+
+void TextRenderer::rasterizeTTFGlyph(int slot, TTF_Font* font, uint32_t codepoint, Glyph& glyph) {
+    // 上次运行时光栅化过的字形直接从磁盘缓存放进图集
+    const CachedGlyph* cached = GlyphCache::lookup(slot, codepoint);
+    if (cached) {
+        glyph.advance = cached->advance;
+        if (!cached->alpha.empty()) {
+            std::vector<uint32_t> pixels(cached->alpha.size());
+            for (size_t i = 0; i < pixels.size(); i++) {
+                pixels[i] = ((uint32_t)cached->alpha[i] << 24) | 0xFFFFFF;
+            }
+            addPixelsToAtlas(pixels.data(), cached->width, cached->height, glyph);
+        }
+        return;
+    }
+    
+    int minx, maxx, miny, maxy, advance;
+    if (TTF_GlyphMetrics(font, (Uint16)codepoint, &minx, &maxx, &miny, &maxy, &advance) != 0) {
+        advance = 0;
+    }
+    glyph.advance = advance;
+    
+    CachedGlyph rendered;
+    rendered.advance = advance;
+    rendered.width = 0;
+    rendered.height = 0;
+    
+    // 白色光栅化，绘制时用颜色调制着色；单个字形的表面高度为整行高度，直接放在笔位置即可
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* surface = TTF_RenderGlyph_Blended(font, (Uint16)codepoint, white);
+    SDL_Surface* converted = surface ? SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0) : nullptr;
+    if (converted) {
+        // 字形为白色，磁盘缓存只保存alpha
+        rendered.width = converted->w;
+        rendered.height = converted->h;
+        rendered.alpha.resize((size_t)converted->w * converted->h);
+        for (int y = 0; y < converted->h; y++) {
+            const uint32_t* row = (const uint32_t*)((const uint8_t*)converted->pixels + y * converted->pitch);
+            for (int x = 0; x < converted->w; x++) {
+                rendered.alpha[y * converted->w + x] = row[x] >> 24;
+            }
+        }
+        addToAtlas(converted, glyph);  // 图集已满时会清空所有字形表
+        SDL_FreeSurface(converted);
+    }
+    if (surface) {
+        SDL_FreeSurface(surface);
+    }
+    GlyphCache::store(slot, codepoint, rendered);
+}
+
+void TextRenderer::addPixelsToAtlas(uint32_t* pixels, int width, int height, Glyph& glyph) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(pixels, width, height, 32, width * 4, SDL_PIXELFORMAT_ARGB8888);
+    if (surface) {
+        addToAtlas(surface, glyph);  // 图集已满时会清空所有字形表
+        SDL_FreeSurface(surface);
+    }
+}
+
+void TextRenderer::rasterizeNFTRGlyph(int index, Glyph& glyph) {
+    // 字形位图只取实际宽度的列，按左侧留白偏移绘制
+    NFTRFont::Metrics metrics = nftrFont.getMetrics(index);
+    glyph.advance = metrics.advance;
+    glyph.offsetX = metrics.left;
+    
+    std::vector<uint32_t> pixels;
+    int width;
+    if (nftrFont.rasterize(index, pixels, width)) {
+        addPixelsToAtlas(pixels.data(), width, nftrFont.getCellHeight(), glyph);
+    }
+}
+
+int TextRenderer::getKerning(int slot, TTF_Font* font, uint32_t previous, uint32_t codepoint) {
+    // 只有ASCII字符对查询字距（CJK字体没有字距，NFTR字体没有字距表），结果缓存在表中
+    if (!font || previous == 0 || previous >= 128 || codepoint >= 128) {
+        return 0;
+    }
+    int8_t& kerning = glyphTables[slot].kerning[previous][codepoint];
+    if (kerning == KERNING_UNKNOWN) {
+        int value = TTF_GetFontKerningSizeGlyphs(font, (Uint16)previous, (Uint16)codepoint);
+        kerning = (int8_t)std::max(-127, std::min(127, value));
+    }
+    return kerning;
+}
+
 TTF_Font* TextRenderer::getFont(int size) {
     if (!fontsLoaded) return nullptr;
     
@@ -113,8 +477,8 @@ void TextRenderer::drawText(int x, int y, const std::string& text, SDL_Color col
     if (!renderer) return;
     
     // 如果字体未加载，使用简单渲染
-    TTF_Font* font = getFont(fontSize);
-    if (!font) {
+    TTF_Font* font;
+    if (!prepareFont(fontSize, font)) {
         // 简单的ASCII字符渲染（备用方案）
         SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
         int currentX = x;
@@ -143,35 +507,162 @@ void TextRenderer::drawText(int x, int y, const std::string& text, SDL_Color col
         return;
     }
     
-    // 使用TTF渲染文本（UTF-8支持，使用Blended模式以获得更好的清晰度）
-    SDL_Surface* textSurface = TTF_RenderUTF8_Blended(font, text.c_str(), color);
-    if (!textSurface) {
-        // 如果UTF-8渲染失败，尝试使用Latin1
-        textSurface = TTF_RenderText_Blended(font, text.c_str(), color);
-        if (!textSurface) {
-            // 如果Blended失败，回退到Solid模式
-            textSurface = TTF_RenderUTF8_Solid(font, text.c_str(), color);
-            if (!textSurface) {
-                textSurface = TTF_RenderText_Solid(font, text.c_str(), color);
-                if (!textSurface) {
-                    std::cerr << "无法渲染文本: " << TTF_GetError() << std::endl;
-                    return;
-                }
-            }
+    if (text.empty()) return;
+    
+    // 第二次出现（连续的另一帧）的字符串合成整串纹理，之后只需一次复制
+    int slot = getFontSlot(fontSize);
+    CachedString& entry = lookupString(text, font, slot);
+    if (!entry.texture && entry.frames >= 2 && !entry.composeFailed) {
+        int height = getLineHeight(font);
+        entry.texture = composeTexture(text, font, slot, entry.width, height);
+        if (entry.texture) {
+            stringBytes += (size_t)entry.width * height * 4;
+        } else {
+            entry.composeFailed = true;
         }
     }
     
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
-    if (!textTexture) {
-        SDL_FreeSurface(textSurface);
+    if (entry.texture) {
+        int width, height;
+        SDL_QueryTexture(entry.texture, nullptr, nullptr, &width, &height);
+        SDL_SetTextureColorMod(entry.texture, color.r, color.g, color.b);
+        SDL_SetTextureAlphaMod(entry.texture, color.a);
+        SDL_Rect destRect = {x, y, width, height};
+        SDL_RenderCopy(renderer, entry.texture, nullptr, &destRect);
         return;
     }
     
-    SDL_Rect destRect = {x, y, textSurface->w, textSurface->h};
-    SDL_RenderCopy(renderer, textTexture, nullptr, &destRect);
+    drawGlyphs(x, y, text, color, font, slot);
+}
+
+void TextRenderer::drawGlyphs(int x, int y, const std::string& text, SDL_Color color, TTF_Font* font, int slot) {
+    // 逐个字形从图集绘制（字形第一次出现时光栅化）
+    int penX = x;
+    uint32_t previous = 0;
+    int lastPage = -1;
+    for (const char* p = text.c_str(); *p; ) {
+        uint32_t codepoint = decodeUTF8(p);
+        Glyph glyph = getGlyph(slot, font, codepoint);
+        penX += getKerning(slot, font, previous, codepoint);
+        if (glyph.page >= 0 && glyph.page < (int)atlasPages.size()) {
+            SDL_Texture* page = atlasPages[glyph.page];
+            if (glyph.page != lastPage) {
+                SDL_SetTextureColorMod(page, color.r, color.g, color.b);
+                SDL_SetTextureAlphaMod(page, color.a);
+                lastPage = glyph.page;
+            }
+            SDL_Rect destRect = {penX + glyph.offsetX, y + glyph.offsetY, glyph.rect.w, glyph.rect.h};
+            SDL_RenderCopy(renderer, page, &glyph.rect, &destRect);
+        }
+        penX += glyph.advance;
+        previous = codepoint;
+    }
+}
+
+SDL_Texture* TextRenderer::composeTexture(const std::string& text, TTF_Font* font, int slot, int width, int height) {
+    if (width <= 0 || height <= 0 || !SDL_RenderTargetSupported(renderer)) {
+        return nullptr;
+    }
+    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (!texture) {
+        return nullptr;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
     
-    SDL_DestroyTexture(textTexture);
-    SDL_FreeSurface(textSurface);
+    // 清成透明的白色：白色字形混合后颜色仍为白色，只有alpha变化，绘制时再调制颜色
+    SDL_SetRenderTarget(renderer, texture);
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 0);
+    SDL_RenderClear(renderer);
+    SDL_Color white = {255, 255, 255, 255};
+    drawGlyphs(0, 0, text, white, font, slot);
+    
+    SDL_SetRenderTarget(renderer, previousTarget);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    return texture;
+}
+
+TextRenderer::CachedString& TextRenderer::lookupString(const std::string& text, TTF_Font* font, int slot) {
+    StringKey key(hashString(text), slot);
+    auto it = stringCache.find(key);
+    if (it != stringCache.end() && it->second.text != text) {
+        // 哈希冲突：替换旧条目
+        releaseString(it->second);
+        stringLru.erase(it->second.lruPos);
+        stringCache.erase(it);
+        it = stringCache.end();
+    }
+    
+    if (it == stringCache.end()) {
+        // 新字符串：先只记录宽度（来自缓存的字形宽度和字距），本帧逐字形绘制
+        CachedString entry;
+        entry.text = text;
+        entry.width = 0;
+        uint32_t previous = 0;
+        for (const char* p = text.c_str(); *p; ) {
+            uint32_t codepoint = decodeUTF8(p);
+            entry.width += getKerning(slot, font, previous, codepoint) + getGlyph(slot, font, codepoint).advance;
+            previous = codepoint;
+        }
+        entry.texture = nullptr;
+        entry.lastFrame = frameCounter;
+        entry.frames = 1;
+        entry.composeFailed = false;
+        stringLru.push_front(key);
+        entry.lruPos = stringLru.begin();
+        return stringCache.emplace(key, entry).first->second;
+    }
+    
+    CachedString& entry = it->second;
+    if (entry.lastFrame != frameCounter) {
+        entry.lastFrame = frameCounter;
+        entry.frames++;
+    }
+    stringLru.splice(stringLru.begin(), stringLru, entry.lruPos);
+    return entry;
+}
+
+void TextRenderer::releaseString(CachedString& entry) {
+    if (entry.texture) {
+        int width, height;
+        SDL_QueryTexture(entry.texture, nullptr, nullptr, &width, &height);
+        stringBytes -= std::min(stringBytes, (size_t)width * height * 4);
+        SDL_DestroyTexture(entry.texture);
+        entry.texture = nullptr;
+    }
+}
+
+void TextRenderer::clearStrings() {
+    for (auto& it : stringCache) {
+        releaseString(it.second);
+    }
+    stringCache.clear();
+    stringLru.clear();
+    stringBytes = 0;
+}
+
+void TextRenderer::nextFrame() {
+    frameCounter++;
+    
+    // 从最久未使用的一端淘汰：太久没用、超出内存预算或条目过多
+    while (!stringLru.empty()) {
+        auto it = stringCache.find(stringLru.back());
+        CachedString& entry = it->second;
+        bool expired = frameCounter - entry.lastFrame > STRING_MAX_AGE;
+        if (!expired && stringBytes <= stringBudget && stringCache.size() <= MAX_STRINGS) {
+            break;
+        }
+        releaseString(entry);
+        stringCache.erase(it);
+        stringLru.pop_back();
+    }
+}
+
+void TextRenderer::setCacheBudget(size_t bytes) {
+    stringBudget = bytes;
 }
 
 void TextRenderer::drawTextCentered(int x, int y, int width, const std::string& text, SDL_Color color, int fontSize) {
@@ -181,8 +672,8 @@ void TextRenderer::drawTextCentered(int x, int y, int width, const std::string&
 }
 
 int TextRenderer::getTextWidth(const std::string& text, int fontSize) {
-    TTF_Font* font = getFont(fontSize);
-    if (!font) {
+    TTF_Font* font;
+    if (!prepareFont(fontSize, font)) {
         // 简单估算（UTF-8字符可能占用多个字节）
         int charCount = 0;
         for (size_t i = 0; i < text.length(); ) {
@@ -207,20 +698,54 @@ int TextRenderer::getTextWidth(const std::string& text, int fontSize) {
         return charCount * 8;
     }
     
-    int w, h;
-    // 尝试UTF-8，如果失败则使用Latin1
-    if (TTF_SizeUTF8(font, text.c_str(), &w, &h) != 0) {
-        if (TTF_SizeText(font, text.c_str(), &w, &h) != 0) {
-            return text.length() * 8;
-        }
-    }
-    return w;
+    // 宽度与整串纹理在同一个缓存中（由缓存的字形宽度和字距计算，与drawText的排版一致）
+    return lookupString(text, font, getFontSlot(fontSize)).width;
 }
 
 int TextRenderer::getTextHeight(int fontSize) {
-    TTF_Font* font = getFont(fontSize);
-    if (!font) {
+    TTF_Font* font;
+    if (!prepareFont(fontSize, font)) {
         return 8;
     }
-    return TTF_FontHeight(font);
+    return getLineHeight(font);
+}
+
+SDL_Texture* TextRenderer::createTextTexture(const std::string& text, int fontSize, int* width, int* height) {
+    TTF_Font* font;
+    if (!renderer || text.empty() || !prepareFont(fontSize, font)) {
+        return nullptr;
+    }
+    
+    // 与drawText相同的排版：用字形图集合成；渲染器不支持渲染目标时用SDL_ttf整串渲染
+    int slot = getFontSlot(fontSize);
+    int textWidth = lookupString(text, font, slot).width;
+    int textHeight = getLineHeight(font);
+    SDL_Texture* composed = composeTexture(text, font, slot, textWidth, textHeight);
+    if (composed) {
+        *width = textWidth;
+        *height = textHeight;
+        return composed;
+    }
+    if (!font) {
+        // NFTR字形只在图集中，没有渲染目标时无法合成
+        return nullptr;
+    }
+    
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* textSurface = TTF_RenderUTF8_Blended(font, text.c_str(), white);
+    if (!textSurface) {
+        textSurface = TTF_RenderText_Blended(font, text.c_str(), white);
+        if (!textSurface) {
+            std::cerr << "无法渲染文本: " << TTF_GetError() << std::endl;
+            return nullptr;
+        }
+    }
+    
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, textSurface);
+    if (texture) {
+        *width = textSurface->w;
+        *height = textSurface->h;
+    }
+    SDL_FreeSurface(textSurface);
+    return texture;
 }
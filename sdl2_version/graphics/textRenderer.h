@@ -3,24 +3,115 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <cstdint>
+#include "nftrFont.h"
 
-// 文本渲染器（使用SDL2_ttf）
+// 字体后端
+enum FontBackend {
+    FONT_BACKEND_TTF = 0,   // 系统TTF字体（SDL2_ttf，默认）
+    FONT_BACKEND_NFTR       // 主题自带的DS系统字体（theme/font/small.nftr），缺少的字符再用TTF补上
+};
+
+// 文本渲染器（使用SDL2_ttf或主题的NFTR字体）
 class TextRenderer {
 public:
     static void init(SDL_Renderer* renderer);
     static void cleanup();
+    
+    // 选择字体后端（字体在第一次绘制时才加载，NFTR后端不需要TTF字体时不会初始化SDL_ttf）
+    static void setBackend(FontBackend backend);
     static void drawText(int x, int y, const std::string& text, SDL_Color color, int fontSize = 12);
     static void drawTextCentered(int x, int y, int width, const std::string& text, SDL_Color color, int fontSize = 12);
     static int getTextWidth(const std::string& text, int fontSize = 12);
     static int getTextHeight(int fontSize = 12);
     
+    // 把文本渲染成白色纹理（调用者负责销毁，绘制时用SDL_SetTextureColorMod着色）
+    // 用于需要重复绘制的文本；字体未加载时返回nullptr
+    static SDL_Texture* createTextTexture(const std::string& text, int fontSize, int* width, int* height);
+    
+    // 整串文本纹理缓存：连续两帧以上出现的字符串合成一张纹理，之后每次绘制只需一次SDL_RenderCopy
+    // 每帧开始时调用nextFrame()，长时间未使用或超出预算的纹理按最久未使用淘汰
+    static void nextFrame();
+    static void setCacheBudget(size_t bytes);
+    static size_t getCacheBytes() { return stringBytes; }
+    
 private:
+    // 字形缓存：每个（字号, 字符）只光栅化一次，放进共享的图集纹理；
+    // 绘制字符串时按缓存的宽度和字距逐个字形SDL_RenderCopy（SDL会合并成批次）
+    struct Glyph {
+        SDL_Rect rect;      // 在图集页中的位置
+        int16_t page;       // 图集页（-1表示没有像素，例如空格）
+        int16_t advance;    // 前进宽度
+        int8_t offsetX;     // 相对笔位置的偏移（NFTR字形的左侧留白、补字字形的垂直居中）
+        int8_t offsetY;
+        bool loaded;
+    };
+    struct GlyphTable {
+        Glyph ascii[128];                      // ASCII直接索引
+        std::map<uint32_t, Glyph> others;      // 其他字符（CJK等）按需加入
+        int8_t kerning[128][128];              // ASCII字距（KERNING_UNKNOWN表示尚未查询）
+    };
+    static const int FONT_SLOT_COUNT = 3;      // 小/中/大三种字号
+    static GlyphTable glyphTables[FONT_SLOT_COUNT];
+    static std::vector<SDL_Texture*> atlasPages;
+    static int shelfX, shelfY, shelfHeight;     // 当前页中的装箱位置（按行排列）
+    
+    static int getFontSlot(int size);
+    static const Glyph& getGlyph(int slot, TTF_Font* font, uint32_t codepoint);
+    static void rasterizeTTFGlyph(int slot, TTF_Font* font, uint32_t codepoint, Glyph& glyph);
+    static void rasterizeNFTRGlyph(int index, Glyph& glyph);
+    static void addPixelsToAtlas(uint32_t* pixels, int width, int height, Glyph& glyph);
+    static bool addToAtlas(SDL_Surface* surface, Glyph& glyph);
+    static int getKerning(int slot, TTF_Font* font, uint32_t previous, uint32_t codepoint);
+    static void clearGlyphs();
+    static void drawGlyphs(int x, int y, const std::string& text, SDL_Color color, TTF_Font* font, int slot);
+    static SDL_Texture* composeTexture(const std::string& text, TTF_Font* font, int slot, int width, int height);
+    
+    // 已测量（以及已合成纹理）的字符串，按（文本哈希, 字号）查找
+    // 纹理为白色，颜色在绘制时调制，所以同一字符串不同颜色共用一张纹理
+    typedef std::pair<uint64_t, int> StringKey;
+    struct CachedString {
+        std::string text;                        // 用于排除哈希冲突
+        int width;
+        SDL_Texture* texture;                    // 尚未合成时为nullptr
+        uint32_t lastFrame;
+        uint32_t frames;                         // 使用过的帧数（第二帧起合成纹理）
+        bool composeFailed;
+        std::list<StringKey>::iterator lruPos;
+    };
+    static std::map<StringKey, CachedString> stringCache;
+    static std::list<StringKey> stringLru;       // 最近使用的在前
+    static size_t stringBytes;
+    static size_t stringBudget;
+    static uint32_t frameCounter;
+    static CachedString& lookupString(const std::string& text, TTF_Font* font, int slot);
+    static void releaseString(CachedString& entry);
+    static void clearStrings();
+    
     static SDL_Renderer* renderer;
+    static FontBackend backend;
+    static NFTRFont nftrFont;
+    static bool nftrTried;
+    static bool loadNFTR();
+    static bool useNFTR() { return backend == FONT_BACKEND_NFTR && nftrFont.isLoaded(); }
+    // 按需加载当前后端的字体；TTF后端时font为对应字号的字体，NFTR后端时为nullptr
+    static bool prepareFont(int size, TTF_Font*& font);
+    static int getLineHeight(TTF_Font* font);
     static TTF_Font* getFont(int size);
     static TTF_Font* smallFont;
     static TTF_Font* mediumFont;
     static TTF_Font* largeFont;
     static bool fontsLoaded;
+    static bool fontsTried;
+    // 字体文件的只读映射（三种字号通过TTF_OpenFontRW共用）
+    static const uint8_t* fontData;
+    static size_t fontDataSize;
+    static void mapFontFile(const char* path);
+    static void unmapFontFile();
+    static TTF_Font* openFont(const char* path, int size);
     static void loadFonts();
     static void freeFonts();
 };
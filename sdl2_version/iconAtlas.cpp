@@ -0,0 +1,160 @@
+#include "iconAtlas.h"
+#include <iostream>
+
+SDL_Renderer* IconAtlas::renderer = nullptr;
+int IconAtlas::maxPages = 2;
+std::vector<SDL_Texture*> IconAtlas::pages;
+std::vector<IconAtlas::Slot> IconAtlas::slots;
+std::vector<int> IconAtlas::freeSlots;
+std::list<int> IconAtlas::lruList;
+
+void IconAtlas::init(SDL_Renderer* renderer, int maxPages) {
+    IconAtlas::renderer = renderer;
+    IconAtlas::maxPages = maxPages < 1 ? 1 : maxPages;
+}
+
+void IconAtlas::cleanup() {
+    for (SDL_Texture* page : pages) {
+        SDL_DestroyTexture(page);
+    }
+    pages.clear();
+    slots.clear();
+    freeSlots.clear();
+    lruList.clear();
+    renderer = nullptr;
+}
+
+void IconAtlas::setMaxPages(int pages, std::vector<std::string>& evicted) {
+    maxPages = pages < 1 ? 1 : pages;
+    trimPages(maxPages, evicted);
+}
+
+void IconAtlas::trimPages(int keepPages, std::vector<std::string>& evicted) {
+    if (keepPages < 0) keepPages = 0;
+    if ((int)pages.size() <= keepPages) return;
+
+    // 淘汰要销毁的页中的所有图标
+    int firstRemoved = keepPages * SLOTS_PER_PAGE;
+    for (int slot = firstRemoved; slot < (int)slots.size(); slot++) {
+        if (slots[slot].used) {
+            evicted.push_back(slots[slot].owner);
+            release(slot);
+        }
+    }
+
+    // 从空闲列表中移除被销毁页的槽位
+    std::vector<int> remaining;
+    for (int slot : freeSlots) {
+        if (slot < firstRemoved) {
+            remaining.push_back(slot);
+        }
+    }
+    freeSlots.swap(remaining);
+
+    for (int page = keepPages; page < (int)pages.size(); page++) {
+        SDL_DestroyTexture(pages[page]);
+    }
+    pages.resize(keepPages);
+    slots.resize(firstRemoved);
+}
+
+bool IconAtlas::addPage() {
+    if (!renderer || (int)pages.size() >= maxPages) {
+        return false;
+    }
+
+    // ABGR8888在小端机器上的字节顺序为R、G、B、A，与解码后的图标像素一致
+    SDL_Texture* page = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ABGR8888,
+                                          SDL_TEXTUREACCESS_STATIC, PAGE_SIZE, PAGE_SIZE);
+    if (!page) {
+        std::cerr << "无法创建图标图集: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_SetTextureBlendMode(page, SDL_BLENDMODE_BLEND);
+
+    int firstSlot = pages.size() * SLOTS_PER_PAGE;
+    pages.push_back(page);
+    slots.resize(pages.size() * SLOTS_PER_PAGE);
+    // 倒序压入，使槽位从页首开始分配
+    for (int i = SLOTS_PER_PAGE - 1; i >= 0; i--) {
+        slots[firstSlot + i].used = false;
+        freeSlots.push_back(firstSlot + i);
+    }
+    return true;
+}
+
+int IconAtlas::allocate(const std::string& owner, const uint32_t* pixels, std::string* evictedOwner) {
+    if (!pixels) return -1;
+
+    int slot = -1;
+    if (freeSlots.empty()) {
+        addPage();
+    }
+
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else if (!lruList.empty()) {
+        // 图集已满：复用最久未使用的槽位
+        slot = lruList.back();
+        lruList.pop_back();
+        slots[slot].used = false;
+        if (evictedOwner) {
+            *evictedOwner = slots[slot].owner;
+        }
+    } else {
+        return -1;
+    }
+
+    IconHandle handle = getHandle(slot);
+    if (SDL_UpdateTexture(handle.texture, &handle.rect, pixels, SLOT_SIZE * sizeof(uint32_t)) != 0) {
+        std::cerr << "无法更新图标图集: " << SDL_GetError() << std::endl;
+        freeSlots.push_back(slot);
+        return -1;
+    }
+
+    Slot& s = slots[slot];
+    s.owner = owner;
+    s.used = true;
+    lruList.push_front(slot);
+    s.lruPos = lruList.begin();
+    return slot;
+}
+
+void IconAtlas::release(int slot) {
+    if (slot < 0 || slot >= (int)slots.size() || !slots[slot].used) return;
+
+    Slot& s = slots[slot];
+    lruList.erase(s.lruPos);
+    s.used = false;
+    s.owner.clear();
+    freeSlots.push_back(slot);
+}
+
+void IconAtlas::releaseAll() {
+    for (int slot = 0; slot < (int)slots.size(); slot++) {
+        release(slot);
+    }
+}
+
+void IconAtlas::touch(int slot) {
+    if (slot < 0 || slot >= (int)slots.size() || !slots[slot].used) return;
+
+    Slot& s = slots[slot];
+    if (s.lruPos != lruList.begin()) {
+        lruList.splice(lruList.begin(), lruList, s.lruPos);
+    }
+}
+
+IconHandle IconAtlas::getHandle(int slot) {
+    IconHandle handle;
+    int page = slot / SLOTS_PER_PAGE;
+    int index = slot % SLOTS_PER_PAGE;
+    handle.texture = (page >= 0 && page < (int)pages.size()) ? pages[page] : nullptr;
+    handle.rect.x = (index % SLOTS_PER_ROW) * SLOT_SIZE;
+    handle.rect.y = (index / SLOTS_PER_ROW) * SLOT_SIZE;
+    handle.rect.w = SLOT_SIZE;
+    handle.rect.h = SLOT_SIZE;
+    handle.flip = SDL_FLIP_NONE;
+    return handle;
+}
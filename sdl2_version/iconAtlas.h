@@ -0,0 +1,70 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+#include <list>
+#include <cstdint>
+
+// 图集中的图标句柄（所在图集页 + 位置 + 绘制时的翻转）
+struct IconHandle {
+    SDL_Texture* texture;
+    SDL_Rect rect;
+    SDL_RendererFlip flip;
+};
+
+// 图标图集：所有32x32的ROM图标共用少量大纹理，
+// 使用空闲列表分配槽位，空间不足时复用最久未使用的槽位
+class IconAtlas {
+public:
+    static const int PAGE_SIZE = 1024;
+    static const int SLOT_SIZE = 32;
+    static const int SLOTS_PER_ROW = PAGE_SIZE / SLOT_SIZE;
+    static const int SLOTS_PER_PAGE = SLOTS_PER_ROW * SLOTS_PER_ROW;
+
+    static const size_t PAGE_BYTES = (size_t)PAGE_SIZE * PAGE_SIZE * 4;
+
+    static void init(SDL_Renderer* renderer, int maxPages = 2);
+    static void cleanup();
+
+    // 设置最大页数；当前页数超出时销毁多余的页，被淘汰的图标所有者放入evicted
+    static void setMaxPages(int pages, std::vector<std::string>& evicted);
+
+    // 只保留前keepPages页（内存压力时释放显存），被淘汰的图标所有者放入evicted
+    static void trimPages(int keepPages, std::vector<std::string>& evicted);
+
+    // 图集占用的显存（字节）
+    static size_t getBytesUsed() { return pages.size() * PAGE_BYTES; }
+
+    // 分配槽位并上传32x32 RGBA像素，返回槽位编号（失败返回-1）
+    // 如果复用了旧槽位，evictedOwner返回旧槽位的所有者
+    static int allocate(const std::string& owner, const uint32_t* pixels, std::string* evictedOwner = nullptr);
+
+    // 释放槽位
+    static void release(int slot);
+
+    // 释放所有槽位（保留图集纹理）
+    static void releaseAll();
+
+    // 标记槽位最近被使用
+    static void touch(int slot);
+
+    // 获取槽位的绘制句柄
+    static IconHandle getHandle(int slot);
+
+private:
+    struct Slot {
+        std::string owner;
+        bool used;
+        std::list<int>::iterator lruPos;
+    };
+
+    static SDL_Renderer* renderer;
+    static int maxPages;
+    static std::vector<SDL_Texture*> pages;
+    static std::vector<Slot> slots;
+    static std::vector<int> freeSlots;
+    static std::list<int> lruList;  // 最近使用的在前
+
+    static bool addPage();
+};
@@ -0,0 +1,175 @@
+// icon_bench：NDS图标解码的对照测试和性能测试（不依赖SDL2）
+// 用同一批随机图标和调色板分别运行旧的逐像素解码、decodeNDSIcon的标量版本和当前编译的版本，
+// 先逐像素比较结果，再分别计时
+#include "ndsBanner.h"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+static const int ICON_COUNT = 256;
+static const int DEFAULT_ROUNDS = 2000;
+
+// 旧的解码方式（原样保留作为参照）：先把tile格式转换为线性格式，再逐像素转换颜色
+static void convertIconTilesToRaw(const u8* tilesSrc, u8* tilesNew) {
+    const int PY = 32;  // 像素高度
+    const int PX = 16;  // 字节宽度（32像素 / 2，因为4位深度）
+    const int TILE_SIZE_Y = 8;
+    const int TILE_SIZE_X = 4;
+    int index = 0;
+
+    for (int tileY = 0; tileY < PY / TILE_SIZE_Y; ++tileY) {
+        for (int tileX = 0; tileX < PX / TILE_SIZE_X; ++tileX) {
+            for (int pY = 0; pY < TILE_SIZE_Y; ++pY) {
+                for (int pX = 0; pX < TILE_SIZE_X; ++pX) {
+                    int destPos = pX + tileX * TILE_SIZE_X + PX * (pY + tileY * TILE_SIZE_Y);
+                    if (destPos >= 0 && destPos < 512 && index < 512) {
+                        tilesNew[destPos] = tilesSrc[index++];
+                    } else {
+                        index++;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void decodeNDSIconReference(const u8* iconData, const u16* palette, u32* pixels) {
+    u8 linearIconData[512];
+    convertIconTilesToRaw(iconData, linearIconData);
+
+    for (int y = 0; y < 32; y++) {
+        for (int x = 0; x < 32; x++) {
+            int index = y * 32 + x;
+            int byteIndex = index / 2;
+            int nibbleIndex = index % 2;
+
+            u8 pixelIndex;
+            if (nibbleIndex == 0) {
+                pixelIndex = linearIconData[byteIndex] & 0x0F;
+            } else {
+                pixelIndex = (linearIconData[byteIndex] >> 4) & 0x0F;
+            }
+
+            u16 rgb15 = palette[pixelIndex];
+            int r = ((rgb15 >> 0) & 31) << 3;
+            int g = ((rgb15 >> 5) & 31) << 3;
+            int b = ((rgb15 >> 10) & 31) << 3;
+            if (r > 255) r = 255;
+            if (g > 255) g = 255;
+            if (b > 255) b = 255;
+
+            u32 a = 255;
+            if (pixelIndex == 0 && rgb15 == 0) {
+                a = 0;
+            }
+
+            pixels[y * 32 + x] = (a << 24) | (b << 16) | (g << 8) | r;
+        }
+    }
+}
+
+typedef void (*DecodeFunc)(const u8* iconData, const u16* palette, u32* pixels);
+
+struct IconSample {
+    u8 icon[512];
+    u16 palette[16];
+};
+
+// 固定种子的xorshift，每次运行使用相同的数据
+static uint32_t nextRandom(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static void makeSamples(std::vector<IconSample>& samples) {
+    uint32_t state = 0x12345678;
+    samples.resize(ICON_COUNT);
+    for (int i = 0; i < ICON_COUNT; i++) {
+        IconSample& sample = samples[i];
+        for (int j = 0; j < 512; j++) {
+            sample.icon[j] = (u8)nextRandom(state);
+        }
+        for (int j = 0; j < 16; j++) {
+            sample.palette[j] = (u16)nextRandom(state);
+        }
+        // 一半的样本索引0为透明色，另一半索引0不透明（位15也参与随机）
+        if (i % 2 == 0) {
+            sample.palette[0] = 0;
+        }
+    }
+}
+
+static const char* vectorVariantName() {
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    return "NEON";
+#elif defined(__SSSE3__)
+    return "SSSE3";
+#else
+    return "标量（未启用NEON/SSSE3）";
+#endif
+}
+
+// 解码全部样本rounds遍，返回每个图标的平均纳秒数
+static double timeDecoder(DecodeFunc decode, const std::vector<IconSample>& samples, int rounds, uint32_t& checksum) {
+    std::vector<u32> pixels(32 * 32);
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (const IconSample& sample : samples) {
+            decode(sample.icon, sample.palette, pixels.data());
+            // 累加一个像素，防止编译器省略解码
+            checksum += pixels[round & 1023];
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / ((double)rounds * samples.size());
+}
+
+int main(int argc, char* argv[]) {
+    int rounds = DEFAULT_ROUNDS;
+    if (argc > 1) {
+        rounds = atoi(argv[1]);
+        if (rounds <= 0) {
+            std::cout << "用法: " << argv[0] << " [轮数]（默认 " << DEFAULT_ROUNDS << "）" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<IconSample> samples;
+    makeSamples(samples);
+
+    // 对照：三种解码结果必须逐像素相同
+    std::vector<u32> expected(32 * 32), scalar(32 * 32), vector(32 * 32);
+    for (int i = 0; i < ICON_COUNT; i++) {
+        decodeNDSIconReference(samples[i].icon, samples[i].palette, expected.data());
+        decodeNDSIconScalar(samples[i].icon, samples[i].palette, scalar.data());
+        decodeNDSIcon(samples[i].icon, samples[i].palette, vector.data());
+        for (int p = 0; p < 32 * 32; p++) {
+            if (scalar[p] != expected[p] || vector[p] != expected[p]) {
+                std::cerr << "解码结果不一致: 图标 " << i << " 像素 (" << p % 32 << ", " << p / 32 << ")"
+                          << std::hex << " 旧 " << expected[p] << " 标量 " << scalar[p]
+                          << " " << vectorVariantName() << " " << vector[p] << std::dec << std::endl;
+                return 1;
+            }
+        }
+    }
+    std::cout << "结果一致: " << ICON_COUNT << " 个随机图标" << std::endl;
+
+    uint32_t checksum = 0;
+    double reference = timeDecoder(decodeNDSIconReference, samples, rounds, checksum);
+    double scalarTime = timeDecoder(decodeNDSIconScalar, samples, rounds, checksum);
+    double vectorTime = timeDecoder(decodeNDSIcon, samples, rounds, checksum);
+
+    std::cout.setf(std::ios::fixed);
+    std::cout.precision(1);
+    std::cout << "每个图标（" << rounds << " 轮 x " << ICON_COUNT << " 个）:" << std::endl;
+    std::cout << "  旧的逐像素解码: " << reference << " ns" << std::endl;
+    std::cout << "  查表（标量）:   " << scalarTime << " ns (" << reference / scalarTime << "x)" << std::endl;
+    std::cout << "  decodeNDSIcon:  " << vectorTime << " ns (" << reference / vectorTime << "x, "
+              << vectorVariantName() << ")" << std::endl;
+    std::cout << "校验和: " << checksum << std::endl;
+    return 0;
+}
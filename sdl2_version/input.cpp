@@ -1,12 +1,18 @@
 #include "input.h"
 #include <cstring>
 #include <vector>
+#include <algorithm>
 #include <iostream>
 #include <SDL2/SDL_gamecontroller.h>
 
 InputState InputManager::currentState = {0};
 InputState InputManager::previousState = {0};
 std::map<SDL_Keycode, NDSKey> InputManager::keyMap;
+InputManager::KeyRepeatState InputManager::keyRepeat[NDS_KEY_COUNT] = {};
+int InputManager::repeatDelay = 300;
+int InputManager::repeatInterval = 100;
+int InputManager::repeatMinInterval = 25;
+int InputManager::repeatAcceleration = 85;
 
 // 手柄支持
 static std::vector<SDL_GameController*> gameControllers;
@@ -128,6 +134,7 @@ void InputManager::update() {
     currentState.keysDown = newKeysHeld & ~previousState.keysHeld;
     currentState.keysUp = previousState.keysHeld & ~newKeysHeld;
     currentState.keysHeld = newKeysHeld;
+    updateRepeat(newKeysHeld);
     
     // 处理鼠标/触摸输入
     int mouseX, mouseY;
@@ -176,6 +183,50 @@ void InputManager::cleanup() {
     memset(&previousState, 0, sizeof(previousState));
 }
 
+void InputManager::updateRepeat(uint16_t keysHeld) {
+    Uint32 now = SDL_GetTicks();
+    currentState.keysRepeat = currentState.keysDown;
+    
+    for (int bit = 0; bit < NDS_KEY_COUNT; bit++) {
+        uint16_t key = 1 << bit;
+        KeyRepeatState& state = keyRepeat[bit];
+        if (currentState.keysDown & key) {
+            // 刚按下：等待delay后开始连发
+            state.nextTime = now + repeatDelay;
+            state.interval = repeatInterval;
+            state.count = 0;
+        } else if (!(keysHeld & key)) {
+            state.count = 0;
+        } else if ((Sint32)(now - state.nextTime) >= 0) {
+            // 每帧最多连发一次，帧率低时不会一次跳过多项
+            currentState.keysRepeat |= key;
+            state.count++;
+            state.nextTime = now + state.interval;
+            state.interval = std::max(repeatMinInterval, state.interval * repeatAcceleration / 100);
+        }
+    }
+}
+
+void InputManager::setKeyRepeat(int delayMs, int intervalMs, int minIntervalMs, int accelerationPercent) {
+    repeatDelay = std::max(0, delayMs);
+    repeatInterval = std::max(1, intervalMs);
+    repeatMinInterval = std::max(1, std::min(minIntervalMs, repeatInterval));
+    repeatAcceleration = std::max(1, std::min(accelerationPercent, 100));
+}
+
+bool InputManager::isKeyDownRepeat(NDSKey key) {
+    return (currentState.keysRepeat & key) != 0;
+}
+
+int InputManager::getRepeatCount(NDSKey key) {
+    for (int bit = 0; bit < NDS_KEY_COUNT; bit++) {
+        if (key & (1 << bit)) {
+            return keyRepeat[bit].count;
+        }
+    }
+    return 0;
+}
+
 InputState InputManager::getState() {
     return currentState;
 }
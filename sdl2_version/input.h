@@ -21,11 +21,15 @@ enum NDSKey {
     KEY_TOUCH = 1 << 12
 };
 
+// 按键位数（KEY_A到KEY_TOUCH）
+static const int NDS_KEY_COUNT = 13;
+
 // 输入状态
 struct InputState {
     uint16_t keysHeld;      // 当前按下的键
     uint16_t keysDown;      // 本帧按下的键
     uint16_t keysUp;        // 本帧释放的键
+    uint16_t keysRepeat;    // 本帧按下或连发的键
     int touchX;             // 触摸X坐标
     int touchY;             // 触摸Y坐标
     bool touchDown;         // 触摸是否按下
@@ -47,6 +51,13 @@ public:
     static bool isKeyDown(NDSKey key);
     static bool isKeyUp(NDSKey key);
     
+    // 按键连发：按下时触发一次，按住delayMs后开始连发，
+    // 之后每次连发间隔乘以accelerationPercent/100，直到minIntervalMs
+    static void setKeyRepeat(int delayMs, int intervalMs, int minIntervalMs, int accelerationPercent);
+    static bool isKeyDownRepeat(NDSKey key);
+    // 本次按住以来的连发次数（刚按下时为0），用于区分单次按键和快速滚动
+    static int getRepeatCount(NDSKey key);
+    
     // 触摸相关
     static bool isTouching();
     static void getTouchPos(int& x, int& y);
@@ -58,6 +69,18 @@ private:
     static InputState currentState;
     static InputState previousState;
     static std::map<SDL_Keycode, NDSKey> keyMap; // 键盘映射表
+    
+    struct KeyRepeatState {
+        Uint32 nextTime;    // 下一次连发的时间
+        int interval;       // 当前连发间隔（毫秒）
+        int count;          // 已连发次数
+    };
+    static KeyRepeatState keyRepeat[NDS_KEY_COUNT];
+    static int repeatDelay;
+    static int repeatInterval;
+    static int repeatMinInterval;
+    static int repeatAcceleration;
+    static void updateRepeat(uint16_t keysHeld);
     static void initKeyMap();
 };
 
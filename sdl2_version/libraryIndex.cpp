@@ -0,0 +1,452 @@
+#include "libraryIndex.h"
+#include "bannerCache.h"
+#include "ndsBanner.h"
+#include "fileTypes.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <SDL2/SDL.h>
+
+// 索引文件格式：
+//   文件头：magic(8) + version(u32) + dirCount(u32) + recordCount(u32) + stringBytes(u32)
+//   之后依次是 dirs、records、字符串池 的原始数据
+static const char INDEX_MAGIC[8] = {'T', 'W', 'L', 'L', 'I', 'B', 'I', 'X'};
+static const uint32_t INDEX_VERSION = 1;
+
+static_assert(sizeof(LibraryIndex::Dir) == 16, "Dir布局变化需要更新INDEX_VERSION");
+static_assert(sizeof(LibraryIndex::Record) == 32, "Record布局变化需要更新INDEX_VERSION");
+
+std::string LibraryIndex::indexPath = "library.bin";
+std::vector<std::string> LibraryIndex::roots;
+std::shared_ptr<const LibraryIndex::Data> LibraryIndex::current;
+std::shared_ptr<LibraryIndex::Data> LibraryIndex::completed;
+std::mutex LibraryIndex::mutex;
+std::thread LibraryIndex::updateThread;
+std::atomic<bool> LibraryIndex::updating(false);
+std::atomic<bool> LibraryIndex::cancelRequested(false);
+
+static std::string joinPath(const std::string& dir, const char* name) {
+    if (!dir.empty() && dir.back() == '/') {
+        return dir + name;
+    }
+    return dir + "/" + name;
+}
+
+uint32_t LibraryIndex::Data::intern(const std::string& str) {
+    uint32_t offset = strings.size();
+    strings.insert(strings.end(), str.begin(), str.end());
+    strings.push_back('\0');
+    return offset;
+}
+
+void LibraryIndex::Data::buildSearchText() {
+    searchText.clear();
+    for (Record& record : records) {
+        record.search = searchText.size();
+        searchText += normalize(str(record.title));
+        searchText += '\x01';
+        searchText += normalize(str(record.name));
+        searchText += '\n';
+    }
+}
+
+std::string LibraryIndex::normalize(const std::string& text) {
+    // 只折叠ASCII大小写；换行等控制字符变为空格（标题中用换行分隔发行商）
+    std::string result = text;
+    for (char& c : result) {
+        if (c >= 'A' && c <= 'Z') {
+            c = c - 'A' + 'a';
+        } else if (c == '\n' || c == '\r' || c == '\t' || c == '\x01') {
+            c = ' ';
+        }
+    }
+    return result;
+}
+
+void LibraryIndex::init(const std::string& rootList, const std::string& indexFile) {
+    joinUpdate();
+    indexPath = indexFile;
+
+    roots.clear();
+    size_t start = 0;
+    while (start <= rootList.size()) {
+        size_t end = rootList.find(';', start);
+        if (end == std::string::npos) end = rootList.size();
+        std::string root = rootList.substr(start, end - start);
+        root.erase(0, root.find_first_not_of(" \t"));
+        root.erase(root.find_last_not_of(" \t") + 1);
+        if (!root.empty()) {
+            roots.push_back(root);
+        }
+        start = end + 1;
+    }
+
+    load();
+}
+
+void LibraryIndex::cleanup() {
+    joinUpdate();
+    std::lock_guard<std::mutex> lock(mutex);
+    current.reset();
+    completed.reset();
+}
+
+void LibraryIndex::joinUpdate() {
+    cancelRequested = true;
+    if (updateThread.joinable()) {
+        updateThread.join();
+    }
+    cancelRequested = false;
+    updating = false;
+}
+
+void LibraryIndex::load() {
+    FILE* fp = fopen(indexPath.c_str(), "rb");
+    if (!fp) {
+        return;  // 还没有索引文件
+    }
+
+    char magic[8];
+    uint32_t version = 0, dirCount = 0, recordCount = 0, stringBytes = 0;
+    std::shared_ptr<Data> data = std::make_shared<Data>();
+    bool ok = fread(magic, sizeof(magic), 1, fp) == 1 &&
+              memcmp(magic, INDEX_MAGIC, sizeof(magic)) == 0 &&
+              fread(&version, 4, 1, fp) == 1 && version == INDEX_VERSION &&
+              fread(&dirCount, 4, 1, fp) == 1 &&
+              fread(&recordCount, 4, 1, fp) == 1 &&
+              fread(&stringBytes, 4, 1, fp) == 1;
+    if (ok) {
+        data->dirs.resize(dirCount);
+        data->records.resize(recordCount);
+        data->strings.resize(stringBytes);
+        ok = (dirCount == 0 || fread(data->dirs.data(), sizeof(Dir), dirCount, fp) == dirCount) &&
+             (recordCount == 0 || fread(data->records.data(), sizeof(Record), recordCount, fp) == recordCount) &&
+             (stringBytes == 0 || fread(data->strings.data(), 1, stringBytes, fp) == stringBytes);
+    }
+    fclose(fp);
+
+    // 校验所有偏移，损坏的索引直接丢弃（之后重新生成）
+    ok = ok && (stringBytes == 0 || data->strings.back() == '\0');
+    for (size_t i = 0; ok && i < data->dirs.size(); i++) {
+        const Dir& dir = data->dirs[i];
+        ok = dir.path < stringBytes && (dir.parent == NO_PARENT || dir.parent < i);
+    }
+    for (size_t i = 0; ok && i < data->records.size(); i++) {
+        const Record& record = data->records[i];
+        ok = record.dir < dirCount && record.name < stringBytes && record.title < stringBytes;
+    }
+    if (!ok) {
+        std::cerr << "ROM库索引无效，忽略: " << indexPath << std::endl;
+        return;
+    }
+
+    data->buildSearchText();
+    current = data;
+    std::cout << "已加载ROM库索引: " << data->records.size() << " 个ROM" << std::endl;
+}
+
+bool LibraryIndex::save(const Data& data) {
+    // 先写入临时文件再重命名，避免中途退出导致索引损坏
+    std::string tmpPath = indexPath + ".tmp";
+    FILE* fp = fopen(tmpPath.c_str(), "wb");
+    if (!fp) {
+        std::cerr << "无法写入ROM库索引: " << tmpPath << std::endl;
+        return false;
+    }
+
+    uint32_t dirCount = data.dirs.size();
+    uint32_t recordCount = data.records.size();
+    uint32_t stringBytes = data.strings.size();
+    bool ok = fwrite(INDEX_MAGIC, sizeof(INDEX_MAGIC), 1, fp) == 1 &&
+              fwrite(&INDEX_VERSION, 4, 1, fp) == 1 &&
+              fwrite(&dirCount, 4, 1, fp) == 1 &&
+              fwrite(&recordCount, 4, 1, fp) == 1 &&
+              fwrite(&stringBytes, 4, 1, fp) == 1 &&
+              fwrite(data.dirs.data(), sizeof(Dir), dirCount, fp) == dirCount &&
+              fwrite(data.records.data(), sizeof(Record), recordCount, fp) == recordCount &&
+              fwrite(data.strings.data(), 1, stringBytes, fp) == stringBytes;
+
+    if (fclose(fp) != 0) ok = false;
+    if (!ok || rename(tmpPath.c_str(), indexPath.c_str()) != 0) {
+        std::cerr << "保存ROM库索引失败: " << indexPath << std::endl;
+        remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+void LibraryIndex::startUpdate() {
+    if (updating || roots.empty()) {
+        return;
+    }
+    joinUpdate();
+    updating = true;
+    updateThread = std::thread(updateWorker, current, roots);
+}
+
+bool LibraryIndex::isUpdating() {
+    return updating;
+}
+
+bool LibraryIndex::poll() {
+    std::shared_ptr<Data> result;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        result.swap(completed);
+    }
+    if (!result) {
+        return false;
+    }
+
+    joinUpdate();
+    current = result;
+    return true;
+}
+
+void LibraryIndex::updateWorker(std::shared_ptr<const Data> previous, std::vector<std::string> rootList) {
+    Uint32 startTime = SDL_GetTicks();
+    std::shared_ptr<Data> data = std::make_shared<Data>();
+
+    // 旧索引：目录路径 -> 下标，每个目录的子目录和记录范围（同一目录的记录是连续的）
+    std::map<std::string, uint32_t> oldDirs;
+    std::vector<std::vector<uint32_t>> oldChildren;
+    std::vector<std::pair<uint32_t, uint32_t>> oldRanges;
+    if (previous) {
+        oldChildren.resize(previous->dirs.size());
+        oldRanges.resize(previous->dirs.size(), std::make_pair(0u, 0u));
+        for (uint32_t i = 0; i < previous->dirs.size(); i++) {
+            const Dir& dir = previous->dirs[i];
+            oldDirs[previous->str(dir.path)] = i;
+            if (dir.parent != NO_PARENT) {
+                oldChildren[dir.parent].push_back(i);
+            }
+        }
+        for (uint32_t i = 0; i < previous->records.size(); i++) {
+            std::pair<uint32_t, uint32_t>& range = oldRanges[previous->records[i].dir];
+            if (range.first == range.second) {
+                range.first = i;
+            }
+            range.second = i + 1;
+        }
+    }
+
+    struct PendingDir {
+        std::string path;
+        uint32_t parent;
+    };
+    std::vector<PendingDir> stack;
+    for (auto it = rootList.rbegin(); it != rootList.rend(); ++it) {
+        stack.push_back({*it, NO_PARENT});
+    }
+
+    std::set<std::pair<dev_t, ino_t>> visited;  // 重叠的根目录和符号链接循环只索引一次
+    size_t reusedDirs = 0, parsedRoms = 0;
+    while (!stack.empty()) {
+        if (cancelRequested) {
+            updating = false;
+            return;
+        }
+
+        PendingDir pending = stack.back();
+        stack.pop_back();
+
+        struct stat st;
+        if (stat(pending.path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+            continue;
+        }
+        if (!visited.insert(std::make_pair(st.st_dev, st.st_ino)).second) {
+            continue;
+        }
+
+        uint32_t dirIndex = data->dirs.size();
+        Dir dir;
+        dir.path = data->intern(pending.path);
+        dir.parent = pending.parent;
+        dir.mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+        data->dirs.push_back(dir);
+
+        auto old = oldDirs.find(pending.path);
+        bool hasOld = old != oldDirs.end();
+        std::vector<std::string> romNames;
+        std::vector<std::string> subdirs;
+
+        if (hasOld && previous->dirs[old->second].mtime == dir.mtime) {
+            // 目录内容没有变化：文件列表和子目录直接取自旧索引
+            reusedDirs++;
+            for (uint32_t i = oldRanges[old->second].first; i < oldRanges[old->second].second; i++) {
+                romNames.push_back(previous->str(previous->records[i].name));
+            }
+            for (uint32_t child : oldChildren[old->second]) {
+                subdirs.push_back(previous->str(previous->dirs[child].path));
+            }
+        } else {
+            DIR* handle = opendir(pending.path.c_str());
+            if (!handle) {
+                continue;
+            }
+            int dirFd = dirfd(handle);
+            struct dirent* entry;
+            while ((entry = readdir(handle)) != nullptr) {
+                // 跳过 . 和 .. 以及隐藏文件
+                if (entry->d_name[0] == '.') {
+                    continue;
+                }
+
+                bool isDirectory = entry->d_type == DT_DIR;
+                if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+                    struct stat entryStat;
+                    isDirectory = fstatat(dirFd, entry->d_name, &entryStat, 0) == 0 && S_ISDIR(entryStat.st_mode);
+                }
+
+                if (isDirectory) {
+                    subdirs.push_back(joinPath(pending.path, entry->d_name));
+                } else if (classifyFileName(entry->d_name) == FILE_TYPE_NDS) {
+                    romNames.push_back(entry->d_name);
+                }
+            }
+            closedir(handle);
+            std::sort(romNames.begin(), romNames.end());
+            std::sort(subdirs.begin(), subdirs.end());
+        }
+
+        // 旧记录：文件名 -> 下标（目录被修改过时用于沿用未变化ROM的标题）
+        std::map<std::string, uint32_t> oldRecords;
+        if (hasOld) {
+            for (uint32_t i = oldRanges[old->second].first; i < oldRanges[old->second].second; i++) {
+                oldRecords[previous->str(previous->records[i].name)] = i;
+            }
+        }
+
+        for (const std::string& name : romNames) {
+            std::string path = joinPath(pending.path, name.c_str());
+            int64_t mtime = 0;
+            uint64_t size = 0;
+            if (!BannerCache::statFile(path, mtime, size)) {
+                continue;
+            }
+
+            Record record;
+            record.dir = dirIndex;
+            record.name = data->intern(name);
+            record.search = 0;
+            record.mtime = mtime;
+            record.size = size;
+
+            auto oldRecord = oldRecords.find(name);
+            if (oldRecord != oldRecords.end() &&
+                previous->records[oldRecord->second].mtime == mtime &&
+                previous->records[oldRecord->second].size == size) {
+                record.title = data->intern(previous->str(previous->records[oldRecord->second].title));
+            } else {
+                // 新增或被修改的ROM：优先使用Banner缓存，否则读取ROM的Banner
+                BannerCacheEntry entry;
+                std::string title;
+                if (BannerCache::lookupCopy(path, entry) || BannerCache::buildEntry(path, entry)) {
+                    title = selectNDSTitle(entry.titles, 1);  // 使用英语标题，与文件列表一致
+                }
+                record.title = data->intern(title);
+                parsedRoms++;
+            }
+            data->records.push_back(record);
+        }
+
+        for (auto it = subdirs.rbegin(); it != subdirs.rend(); ++it) {
+            stack.push_back({*it, dirIndex});
+        }
+    }
+
+    data->buildSearchText();
+    save(*data);
+
+    std::cout << "ROM库索引已更新: " << data->records.size() << " 个ROM, "
+              << data->dirs.size() << " 个目录（" << reusedDirs << " 个未变化）, 读取Banner "
+              << parsedRoms << " 个, 用时 " << (SDL_GetTicks() - startTime) << " ms" << std::endl;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    completed = data;
+    updating = false;
+}
+
+void LibraryIndex::search(const std::string& query, std::vector<uint32_t>& results) {
+    results.clear();
+    if (!current) {
+        return;
+    }
+
+    const Data& data = *current;
+    std::string needle = normalize(query);
+    needle.erase(0, needle.find_first_not_of(' '));
+    if (needle.empty()) {
+        results.reserve(data.records.size());
+        for (uint32_t i = 0; i < data.records.size(); i++) {
+            results.push_back(i);
+        }
+        return;
+    }
+
+    // 在连续的搜索文本上用memmem查找，再根据偏移找到所在记录
+    const char* text = data.searchText.data();
+    const char* textEnd = text + data.searchText.size();
+    std::vector<uint32_t> substringMatches;
+    const char* pos = text;
+    while (pos < textEnd) {
+        const char* hit = (const char*)memmem(pos, textEnd - pos, needle.data(), needle.size());
+        if (!hit) {
+            break;
+        }
+
+        size_t offset = hit - text;
+        auto it = std::upper_bound(data.records.begin(), data.records.end(), offset,
+                                   [](size_t value, const Record& record) { return value < record.search; });
+        uint32_t index = (it - data.records.begin()) - 1;
+        const char* recordStart = text + data.records[index].search;
+        const char* recordEnd = index + 1 < data.records.size() ? text + data.records[index + 1].search : textEnd;
+
+        // 同一条记录中可能还有位于单词开头的匹配
+        bool wordStart = false;
+        for (const char* h = hit; h; ) {
+            if (h == recordStart || h[-1] == ' ' || h[-1] == '\x01') {
+                wordStart = true;
+                break;
+            }
+            h = (const char*)memmem(h + 1, recordEnd - (h + 1), needle.data(), needle.size());
+        }
+        (wordStart ? results : substringMatches).push_back(index);
+
+        // 每条记录只出现一次
+        pos = recordEnd;
+    }
+
+    results.insert(results.end(), substringMatches.begin(), substringMatches.end());
+}
+
+size_t LibraryIndex::size() {
+    return current ? current->records.size() : 0;
+}
+
+const LibraryIndex::Record& LibraryIndex::getRecord(uint32_t index) {
+    return current->records[index];
+}
+
+const char* LibraryIndex::getName(uint32_t index) {
+    return current->str(current->records[index].name);
+}
+
+const char* LibraryIndex::getTitle(uint32_t index) {
+    return current->str(current->records[index].title);
+}
+
+const char* LibraryIndex::getDirectory(uint32_t dir) {
+    return current->str(current->dirs[dir].path);
+}
+
+std::string LibraryIndex::getPath(uint32_t index) {
+    const Record& record = current->records[index];
+    return joinPath(current->str(current->dirs[record.dir].path), current->str(record.name));
+}
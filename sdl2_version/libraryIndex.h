@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// ROM库索引：收集若干根目录下（递归）的全部NDS/DSi文件，按标题搜索时不需要遍历目录
+// 所有字符串存放在一个字符串池中，目录和ROM记录都是定长的平坦数组，可以直接写入磁盘
+class LibraryIndex {
+public:
+    struct Dir {
+        uint32_t path;         // 目录路径在字符串池中的偏移
+        uint32_t parent;       // 上级目录（根目录为NO_PARENT）
+        int64_t mtime;         // 目录修改时间（纳秒），未变化时沿用旧记录
+    };
+
+    struct Record {
+        uint32_t dir;          // 所在目录在dirs中的下标
+        uint32_t name;         // 文件名在字符串池中的偏移
+        uint32_t title;        // 标题（UTF-8，没有Banner时为空字符串）
+        uint32_t search;       // 规范化文本在搜索缓冲区中的偏移（加载时重建）
+        int64_t mtime;         // ROM修改时间
+        uint64_t size;         // ROM文件大小
+    };
+
+    static const uint32_t NO_PARENT = 0xFFFFFFFF;
+
+    // roots为以';'分隔的根目录列表；加载上次保存的索引（不访问ROM目录）
+    static void init(const std::string& roots, const std::string& indexFile = "library.bin");
+    static void cleanup();
+
+    // 在后台线程中增量更新索引：修改时间未变的目录不重新读取，
+    // 只有新增或被修改的ROM才读取Banner
+    static void startUpdate();
+    static bool isUpdating();
+
+    // 主线程每帧调用：后台更新完成时切换到新索引并保存，返回true
+    static bool poll();
+
+    // 按标题和文件名搜索（ASCII忽略大小写），结果为记录下标
+    // 在标题或单词开头匹配的排在前面，其余按子串匹配；空查询返回全部记录
+    static void search(const std::string& query, std::vector<uint32_t>& results);
+
+    static size_t size();
+    static const Record& getRecord(uint32_t index);
+    static const char* getName(uint32_t index);
+    static const char* getTitle(uint32_t index);
+    static std::string getPath(uint32_t index);
+    static const char* getDirectory(uint32_t dir);
+
+private:
+    struct Data {
+        std::vector<Dir> dirs;
+        std::vector<Record> records;
+        std::vector<char> strings;     // 以'\0'结尾的字符串依次存放
+        std::string searchText;        // 每条记录："规范化标题\x01规范化文件名\n"
+
+        uint32_t intern(const std::string& str);
+        const char* str(uint32_t offset) const { return &strings[offset]; }
+        void buildSearchText();
+    };
+
+    static std::string indexPath;
+    static std::vector<std::string> roots;
+    static std::shared_ptr<const Data> current;   // 只在主线程替换
+    static std::shared_ptr<Data> completed;       // 后台更新的结果，等待主线程切换
+    static std::mutex mutex;
+    static std::thread updateThread;
+    static std::atomic<bool> updating;
+    static std::atomic<bool> cancelRequested;
+
+    static void load();
+    static bool save(const Data& data);
+    static void updateWorker(std::shared_ptr<const Data> previous, std::vector<std::string> rootList);
+    static void joinUpdate();
+    static std::string normalize(const std::string& text);
+};
@@ -0,0 +1,286 @@
+// list_bench：大目录列表视图的性能测试（无窗口：SDL软件渲染器绘制到内存表面）
+// 生成一个有N个ROM文件（默认50000）的临时目录，由FileBrowser扫描成列表，然后分别计时：
+//   - 列表视图每帧的工作（可见行的显示模型、文字纹理、绘制），按逐行滚动、翻页、首字母跳转和随机跳转统计
+//     （测试文件没有Banner，不包括后台线程读取标题）
+//   - 首字母索引的建立和跳转
+//   - 排序方式切换（第一次计算顺序，之后按缓存的顺序重排）
+// 并检查列表视图在没有输入时跳过绘制（网格的滚动动画不应使列表视图一直重绘）
+// 需要在程序目录中运行（与主程序使用相同的字体和主题路径）
+#include "fileBrowser.h"
+#include "listView.h"
+#include "graphics/textRenderer.h"
+#include "graphics/glyphCache.h"
+#include "gameGrid.h"
+#include "dirtyTracker.h"
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+extern SDL_Renderer* g_renderer;
+
+static const int DEFAULT_ENTRY_COUNT = 50000;
+static const double FRAME_BUDGET_MS = 1000.0 / 60.0;
+
+// 固定种子的xorshift，每次运行使用相同的数据
+static uint32_t randomState = 0x2468ACE1;
+static uint32_t nextRandom() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 生成测试目录：文件名的首字母和数字随机，大小（稀疏文件）和修改时间随机
+static bool createEntries(const std::string& dirPath, int count) {
+    static const char* words[] = {"Adventure", "Battle", "Castle", "Dragon", "Puzzle", "Quest", "Racing", "Star"};
+    for (int i = 0; i < count; i++) {
+        char name[96];
+        snprintf(name, sizeof(name), "%c%s %d (%05d).nds", 'A' + nextRandom() % 26,
+                 words[nextRandom() % 8], (int)(nextRandom() % 100), i);
+        std::string path = dirPath + "/" + name;
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "无法创建测试文件: " << path << std::endl;
+            return false;
+        }
+        bool ok = ftruncate(fd, 512 * 1024 + nextRandom() % (64 * 1024 * 1024)) == 0;
+        struct timespec times[2];
+        times[0].tv_sec = times[1].tv_sec = 1500000000 + nextRandom() % 200000000;
+        times[0].tv_nsec = times[1].tv_nsec = 0;
+        ok = futimens(fd, times) == 0 && ok;
+        close(fd);
+        if (!ok) {
+            std::cerr << "无法设置测试文件: " << path << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static void removeDirectory(const std::string& dirPath) {
+    DIR* dir = opendir(dirPath.c_str());
+    if (dir) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+                unlink((dirPath + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(dir);
+    }
+    rmdir(dirPath.c_str());
+}
+
+struct FrameStats {
+    double total;
+    double worst;
+    std::vector<double> samples;
+};
+
+// 绘制一帧列表视图（与主循环相同：文本缓存按帧计数，清屏，绘制列表）
+static double renderFrame(FileBrowser& browser, int selected) {
+    auto start = std::chrono::steady_clock::now();
+    TextRenderer::nextFrame();
+    SDL_SetRenderDrawColor(g_renderer, 0, 0, 0, 255);
+    SDL_RenderClear(g_renderer);
+    ListView::render(&browser, selected);
+    SDL_RenderPresent(g_renderer);
+    return elapsedMs(start);
+}
+
+// 运行frames帧，每帧由next决定新的选中项
+template <typename Next>
+static FrameStats runFrames(FileBrowser& browser, int frames, Next next) {
+    FrameStats stats = {0, 0, {}};
+    int selected = 0;
+    browser.setSelectedIndex(0);
+    renderFrame(browser, selected);
+    for (int frame = 0; frame < frames; frame++) {
+        auto start = std::chrono::steady_clock::now();
+        selected = next(selected);
+        browser.setSelectedIndex(selected);
+        double ms = elapsedMs(start) + renderFrame(browser, selected);
+        stats.total += ms;
+        stats.worst = std::max(stats.worst, ms);
+        stats.samples.push_back(ms);
+    }
+    return stats;
+}
+
+// 输出一种操作的每帧耗时，返回平均值是否在60fps的帧时间以内
+static bool report(const char* name, FrameStats& stats) {
+    std::sort(stats.samples.begin(), stats.samples.end());
+    double average = stats.total / stats.samples.size();
+    double p99 = stats.samples[stats.samples.size() * 99 / 100];
+    printf("  %-12s 平均 %7.3f ms  p99 %7.3f ms  最大 %7.3f ms  （60fps预算的 %.1f%%）\n",
+           name, average, p99, stats.worst, average * 100 / FRAME_BUDGET_MS);
+    return average <= FRAME_BUDGET_MS;
+}
+
+int main(int argc, char* argv[]) {
+    int count = DEFAULT_ENTRY_COUNT;
+    bool useNFTR = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--nftr") == 0) {
+            useNFTR = true;
+        } else if (atoi(argv[i]) > 0) {
+            count = atoi(argv[i]);
+        } else {
+            std::cout << "用法: " << argv[0] << " [条目数]（默认 " << DEFAULT_ENTRY_COUNT << "） [--nftr]" << std::endl;
+            return 1;
+        }
+    }
+
+    char dirTemplate[] = "/tmp/list_bench.XXXXXX";
+    if (!mkdtemp(dirTemplate)) {
+        std::cerr << "无法创建临时目录" << std::endl;
+        return 1;
+    }
+    std::string dirPath = dirTemplate;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!createEntries(dirPath, count)) {
+        removeDirectory(dirPath);
+        return 1;
+    }
+    printf("生成 %d 个测试文件: %.0f ms\n", count, elapsedMs(start));
+
+    // 无窗口渲染：软件渲染器绘制到与屏幕大小相同的内存表面
+    SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+        std::cerr << "SDL初始化失败: " << SDL_GetError() << std::endl;
+        removeDirectory(dirPath);
+        return 1;
+    }
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 256, 384, 32, SDL_PIXELFORMAT_ARGB8888);
+    g_renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!g_renderer) {
+        std::cerr << "无法创建软件渲染器: " << SDL_GetError() << std::endl;
+        removeDirectory(dirPath);
+        return 1;
+    }
+
+    // 字形磁盘缓存放在临时目录中：测量的是没有缓存时的光栅化
+    GlyphCache::init(dirPath + "/glyphcache.bin");
+    TextRenderer::init(g_renderer);
+    TextRenderer::setBackend(useNFTR ? FONT_BACKEND_NFTR : FONT_BACKEND_TTF);
+
+    bool ok = true;
+    bool idle = true;
+    {
+        FileBrowser browser;
+        start = std::chrono::steady_clock::now();
+        browser.init(dirPath);
+        while (browser.isScanning()) {
+            browser.pollChanges();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        browser.pollChanges();
+        int entries = browser.getFiles().size();
+        printf("扫描并排序 %d 个条目: %.0f ms\n", entries, elapsedMs(start));
+
+        // 列表视图每帧的工作
+        ListView::setEnabled(true);
+        printf("列表视图每帧（%d 行可见）:\n", ListView::getVisibleRows());
+        int page = ListView::getVisibleRows();
+        FrameStats lineStats = runFrames(browser, 3000, [entries](int selected) {
+            return (selected + 1) % entries;
+        });
+        FrameStats pageStats = runFrames(browser, 1000, [entries, page](int selected) {
+            return (selected + page) % entries;
+        });
+        FrameStats letterStats = runFrames(browser, 1000, [&browser](int selected) {
+            int next = browser.getLetterGroupStart(selected, 1);
+            return next != selected ? next : 0;
+        });
+        FrameStats randomStats = runFrames(browser, 1000, [entries](int) {
+            return (int)(nextRandom() % entries);
+        });
+        ok = report("逐行滚动", lineStats) && ok;
+        ok = report("翻页", pageStats) && ok;
+        ok = report("首字母跳转", letterStats) && ok;
+        ok = report("随机跳转", randomStats) && ok;
+
+        // 排序方式切换：第一次计算并缓存顺序，第二次只按编号重排；之后首字母索引重新建立一次
+        printf("排序方式切换:\n");
+        const FileBrowser::SortMode modes[] = {
+            FileBrowser::SORT_TITLE, FileBrowser::SORT_SIZE, FileBrowser::SORT_MTIME,
+            FileBrowser::SORT_PLAY_COUNT, FileBrowser::SORT_NAME
+        };
+        for (int pass = 0; pass < 2; pass++) {
+            for (FileBrowser::SortMode mode : modes) {
+                start = std::chrono::steady_clock::now();
+                browser.setSortMode(mode);
+                double sortMs = elapsedMs(start);
+                start = std::chrono::steady_clock::now();
+                browser.getLetterStart(1);
+                double letterMs = elapsedMs(start);
+                printf("  %s %-10s %8.3f ms  首字母索引 %6.3f ms\n", pass == 0 ? "计算" : "缓存",
+                       FileBrowser::getSortModeName(mode), sortMs, letterMs);
+            }
+        }
+
+        // 首字母索引建立后的跳转
+        const int jumps = 100000;
+        int index = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < jumps; i++) {
+            index = browser.getLetterGroupStart(index, (i & 1) ? -1 : 2);
+        }
+        printf("首字母跳转: 每次 %.3f us\n", elapsedMs(start) * 1000 / jumps);
+
+        // 空闲检测：与主循环相同，列表视图用GameGrid::setSelectedIndex移动选中项（网格的目标滚动位置随之改变，
+        // 但网格不更新动画），之后没有输入的帧应该全部跳过
+        GameGrid::setMaxItems(entries);
+        GameGrid::setSelectedIndex(entries / 2);
+        UIState state = {};
+        state.selectedIndex = GameGrid::getSelectedIndex();
+        state.scrollOffset = GameGrid::getScrollOffset();
+        state.listTopRow = ListView::getFirstVisible();
+        state.itemCount = entries;
+        state.listView = true;
+        DirtyTracker::invalidate();
+        DirtyTracker::shouldRender(state, true);
+        const int idleFrames = 10;
+        int skipped = 0;
+        for (int frame = 0; frame < idleFrames; frame++) {
+            if (DirtyTracker::isGridAnimating(state)) {
+                DirtyTracker::invalidate();
+            }
+            if (!DirtyTracker::shouldRender(state, false)) {
+                skipped++;
+            }
+        }
+        idle = skipped == idleFrames;
+        printf("列表视图空闲: 没有输入的 %d 帧中跳过 %d 帧%s\n", idleFrames, skipped, idle ? "" : "（应全部跳过）");
+
+        ListView::cleanup();
+    }
+
+    TextRenderer::cleanup();
+    SDL_DestroyRenderer(g_renderer);
+    g_renderer = nullptr;
+    SDL_FreeSurface(surface);
+    SDL_Quit();
+    removeDirectory(dirPath);
+
+    if (!ok) {
+        printf("列表视图的平均帧时间超过60fps预算（%.2f ms）\n", FRAME_BUDGET_MS);
+    }
+    return ok && idle ? 0 : 1;
+}
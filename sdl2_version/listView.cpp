@@ -0,0 +1,288 @@
+#include "listView.h"
+#include "gameGrid.h"
+#include "input.h"
+#include "ndsIconLoader.h"
+#include "graphics/textRenderer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+extern SDL_Renderer* g_renderer;
+
+// 布局（下屏，y坐标+192）
+static const int LIST_X = 4;
+static const int LIST_Y = 192 + 6;
+static const int LIST_WIDTH = 248;
+static const int ROW_HEIGHT = 14;
+static const int FONT_SIZE = 12;
+static const int LABEL_X = LIST_X + 4;
+static const int SIZE_RIGHT = LIST_X + LIST_WIDTH - 10;   // 大小一列右对齐
+static const int SIZE_COLUMN_WIDTH = 44;
+static const int SCROLLBAR_X = LIST_X + LIST_WIDTH - 6;
+
+bool ListView::enabled = false;
+int ListView::topRow = 0;
+std::map<int, ListView::Row> ListView::rows;
+SDL_Texture* ListView::letterTextures[FileBrowser::LETTER_COUNT] = {nullptr};
+
+// 格式化文件大小（只在生成行时调用一次）
+static std::string formatSize(uint64_t size) {
+    char buffer[32];
+    if (size < 1024) {
+        snprintf(buffer, sizeof(buffer), "%uB", (unsigned)size);
+    } else if (size < 1024 * 1024) {
+        snprintf(buffer, sizeof(buffer), "%.1fK", size / 1024.0);
+    } else if (size < 1024ULL * 1024 * 1024) {
+        snprintf(buffer, sizeof(buffer), "%.1fM", size / (1024.0 * 1024.0));
+    } else {
+        snprintf(buffer, sizeof(buffer), "%.1fG", size / (1024.0 * 1024.0 * 1024.0));
+    }
+    return buffer;
+}
+
+// 截断到maxWidth像素以内，末尾加"..."（按UTF-8字符边界二分查找）
+static std::string truncateToWidth(const std::string& text, int maxWidth) {
+    if (TextRenderer::getTextWidth(text, FONT_SIZE) <= maxWidth) {
+        return text;
+    }
+
+    std::vector<size_t> boundaries;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (((unsigned char)text[i] & 0xC0) != 0x80) {
+            boundaries.push_back(i);
+        }
+    }
+
+    // 能放下的最长前缀（至少保留一个字符）
+    size_t low = 1, high = boundaries.size();
+    while (low < high) {
+        size_t middle = (low + high + 1) / 2;
+        if (TextRenderer::getTextWidth(text.substr(0, boundaries[middle]) + "...", FONT_SIZE) <= maxWidth) {
+            low = middle;
+        } else {
+            high = middle - 1;
+        }
+    }
+    size_t length = low < boundaries.size() ? boundaries[low] : text.size();
+    return text.substr(0, length) + "...";
+}
+
+void ListView::setEnabled(bool enable) {
+    enabled = enable;
+    if (!enabled) {
+        cleanup();
+    }
+}
+
+void ListView::cleanup() {
+    for (auto& it : rows) {
+        destroyRow(it.second);
+    }
+    rows.clear();
+    for (int i = 0; i < FileBrowser::LETTER_COUNT; i++) {
+        if (letterTextures[i]) {
+            SDL_DestroyTexture(letterTextures[i]);
+            letterTextures[i] = nullptr;
+        }
+    }
+    topRow = 0;
+}
+
+void ListView::follow(int selectedIndex, int count) {
+    // 选中行保持在可见范围内
+    if (selectedIndex < topRow) {
+        topRow = selectedIndex;
+    } else if (selectedIndex >= topRow + VISIBLE_ROWS) {
+        topRow = selectedIndex - VISIBLE_ROWS + 1;
+    }
+    topRow = std::max(0, std::min(topRow, count - VISIBLE_ROWS));
+}
+
+void ListView::update(FileBrowser* browser) {
+    int count = browser->getFiles().size();
+    if (count == 0) {
+        return;
+    }
+
+    int selected = GameGrid::getSelectedIndex();
+    int target = selected;
+    if (InputManager::isKeyDownRepeat(KEY_UP)) {
+        target = selected - 1;
+    } else if (InputManager::isKeyDownRepeat(KEY_DOWN)) {
+        target = selected + 1;
+    } else if (InputManager::isKeyDownRepeat(KEY_L)) {
+        target = selected - VISIBLE_ROWS;
+    } else if (InputManager::isKeyDownRepeat(KEY_R)) {
+        target = selected + VISIBLE_ROWS;
+    } else if (InputManager::isKeyDownRepeat(KEY_LEFT)) {
+        target = browser->getLetterGroupStart(selected, -1);
+    } else if (InputManager::isKeyDownRepeat(KEY_RIGHT)) {
+        target = browser->getLetterGroupStart(selected, 1);
+    }
+
+    target = std::max(0, std::min(target, count - 1));
+    if (target != selected) {
+        GameGrid::setSelectedIndex(target);
+        // 连续滚动时丢弃已经滚出屏幕的行排队中的标题读取
+        if (GameGrid::isFastScrolling()) {
+            NDSIconLoader::cancelQueuedRequests();
+        }
+    }
+    follow(target, count);
+}
+
+void ListView::destroyRow(Row& row) {
+    if (row.labelTexture) {
+        SDL_DestroyTexture(row.labelTexture);
+        row.labelTexture = nullptr;
+    }
+    if (row.sizeTexture) {
+        SDL_DestroyTexture(row.sizeTexture);
+        row.sizeTexture = nullptr;
+    }
+}
+
+void ListView::buildRow(Row& row, const FileListing& files, const FileEntry& entry) {
+    destroyRow(row);
+    row.label = files.getTitle(entry);
+    row.flags = entry.flags;
+    row.size = entry.size;
+
+    std::string sizeText;
+    if (entry.isParent()) {
+        sizeText = "";
+    } else if (entry.isDirectory()) {
+        sizeText = "DIR";
+    } else if (entry.metadataPending()) {
+        sizeText = "...";
+    } else {
+        sizeText = formatSize(entry.size);
+    }
+
+    std::string label = truncateToWidth(row.label, SIZE_RIGHT - SIZE_COLUMN_WIDTH - LABEL_X);
+    row.labelTexture = TextRenderer::createTextTexture(label, FONT_SIZE, &row.labelWidth, &row.labelHeight);
+    row.sizeTexture = TextRenderer::createTextTexture(sizeText, FONT_SIZE, &row.sizeWidth, &row.sizeHeight);
+}
+
+ListView::Row& ListView::getRow(const FileListing& files, int index) {
+    const FileEntry& entry = files[index];
+    auto it = rows.find(index);
+    if (it != rows.end()) {
+        // 行号相同但条目内容可能已经变化（列表重新排序、标题或大小读取完成）
+        Row& row = it->second;
+        if (row.flags == entry.flags && row.size == entry.size &&
+            strcmp(row.label.c_str(), files.getTitle(entry)) == 0) {
+            return row;
+        }
+        buildRow(row, files, entry);
+        return row;
+    }
+
+    Row& row = rows[index];
+    row.labelTexture = nullptr;
+    row.sizeTexture = nullptr;
+    buildRow(row, files, entry);
+    return row;
+}
+
+void ListView::evictRows() {
+    // 只保留前后各一页，快速滚动时显示模型的大小不随列表增长
+    int first = topRow - VISIBLE_ROWS;
+    int last = topRow + VISIBLE_ROWS * 2;
+    for (auto it = rows.begin(); it != rows.end();) {
+        if (it->first < first || it->first >= last) {
+            destroyRow(it->second);
+            it = rows.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ListView::drawLetterIndicator(FileBrowser* browser, int selectedIndex, int y) {
+    if (selectedIndex < 0 || selectedIndex >= (int)browser->getFiles().size()) {
+        return;
+    }
+    int letter = browser->getEntryLetter(selectedIndex);
+    SDL_Texture*& texture = letterTextures[letter];
+    int width = 0, height = 0;
+    if (!texture) {
+        texture = TextRenderer::createTextTexture(std::string(1, FileBrowser::getLetterName(letter)), FONT_SIZE, &width, &height);
+    }
+    if (!texture) {
+        return;
+    }
+    SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+
+    SDL_Rect box = {SCROLLBAR_X - 20, y, 16, 16};
+    SDL_SetRenderDrawColor(g_renderer, 60, 60, 120, 230);
+    SDL_RenderFillRect(g_renderer, &box);
+    SDL_Rect letterRect = {box.x + (box.w - width) / 2, box.y + (box.h - height) / 2, width, height};
+    SDL_SetTextureColorMod(texture, 255, 255, 255);
+    SDL_RenderCopy(g_renderer, texture, nullptr, &letterRect);
+}
+
+void ListView::render(FileBrowser* browser, int selectedIndex) {
+    if (!g_renderer || !browser) return;
+
+    const FileListing& files = browser->getFiles();
+    int count = files.size();
+    follow(selectedIndex, count);
+
+    // 列表背景
+    SDL_SetRenderDrawBlendMode(g_renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(g_renderer, 30, 30, 30, 200);
+    SDL_Rect bgRect = {LIST_X, LIST_Y - 2, LIST_WIDTH, VISIBLE_ROWS * ROW_HEIGHT + 4};
+    SDL_RenderFillRect(g_renderer, &bgRect);
+
+    int lastRow = std::min(topRow + VISIBLE_ROWS, count);
+    for (int i = topRow; i < lastRow; i++) {
+        int y = LIST_Y + (i - topRow) * ROW_HEIGHT;
+        const FileEntry& entry = files[i];
+
+        if (i == selectedIndex) {
+            SDL_SetRenderDrawColor(g_renderer, 60, 60, 120, 255);
+            SDL_Rect highlightRect = {LIST_X + 2, y, LIST_WIDTH - 12, ROW_HEIGHT};
+            SDL_RenderFillRect(g_renderer, &highlightRect);
+        }
+
+        // 文字纹理为白色，颜色在绘制时调制
+        SDL_Color textColor;
+        if (i == selectedIndex) {
+            textColor = {255, 255, 255, 255};
+        } else if (entry.isDirectory()) {
+            textColor = {150, 200, 255, 255};
+        } else {
+            textColor = {200, 200, 200, 255};
+        }
+
+        Row& row = getRow(files, i);
+        if (row.labelTexture) {
+            SDL_SetTextureColorMod(row.labelTexture, textColor.r, textColor.g, textColor.b);
+            SDL_Rect labelRect = {LABEL_X, y + (ROW_HEIGHT - row.labelHeight) / 2, row.labelWidth, row.labelHeight};
+            SDL_RenderCopy(g_renderer, row.labelTexture, nullptr, &labelRect);
+        }
+        if (row.sizeTexture) {
+            SDL_SetTextureColorMod(row.sizeTexture, 150, 150, 150);
+            SDL_Rect sizeRect = {SIZE_RIGHT - row.sizeWidth, y + (ROW_HEIGHT - row.sizeHeight) / 2, row.sizeWidth, row.sizeHeight};
+            SDL_RenderCopy(g_renderer, row.sizeTexture, nullptr, &sizeRect);
+        }
+    }
+    evictRows();
+
+    // 滚动条和当前首字母（条目很多时滑块保持最小高度）
+    if (count > VISIBLE_ROWS) {
+        int trackHeight = VISIBLE_ROWS * ROW_HEIGHT;
+        int thumbHeight = std::max(16, trackHeight * VISIBLE_ROWS / count);
+        int thumbY = LIST_Y + (int)((int64_t)topRow * (trackHeight - thumbHeight) / (count - VISIBLE_ROWS));
+        SDL_SetRenderDrawColor(g_renderer, 100, 100, 100, 255);
+        SDL_Rect thumb = {SCROLLBAR_X, thumbY, 4, thumbHeight};
+        SDL_RenderFillRect(g_renderer, &thumb);
+
+        // 按住左右键按首字母跳转时显示当前字母
+        if (InputManager::isKeyHeld(KEY_LEFT) || InputManager::isKeyHeld(KEY_RIGHT)) {
+            drawLetterIndicator(browser, selectedIndex, std::min(thumbY, LIST_Y + trackHeight - 16));
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <string>
+#include <map>
+#include <cstdint>
+#include "fileBrowser.h"
+
+// 下屏列表视图（适合几万个条目的大目录）：每行一个条目，只绘制可见的行
+// 每行的显示文本（格式化好的大小、按像素截断的标题）和文字纹理保存在显示模型中，
+// 条目内容不变时滚动和重绘都不再格式化字符串或渲染文字
+// 选中项与网格共用GameGrid的选中位置
+class ListView {
+public:
+    static void cleanup();
+
+    static bool isEnabled() { return enabled; }
+    static void setEnabled(bool enable);
+
+    // 处理输入：上/下逐行，L/R翻页，左/右跳到上一个/下一个首字母组
+    static void update(FileBrowser* browser);
+    static void render(FileBrowser* browser, int selectedIndex);
+
+    // 可见行范围（读取标题和大小用）
+    static int getFirstVisible() { return topRow; }
+    static int getVisibleRows() { return VISIBLE_ROWS; }
+
+private:
+    static const int VISIBLE_ROWS = 12;
+
+    // 显示模型中的一行：记录生成时的条目内容，内容变化（标题或大小读取完成、列表变化）时重新生成
+    struct Row {
+        std::string label;        // 标题（没有时为文件名）
+        uint8_t flags;
+        uint64_t size;
+        SDL_Texture* labelTexture;
+        int labelWidth, labelHeight;
+        SDL_Texture* sizeTexture;
+        int sizeWidth, sizeHeight;
+    };
+
+    static bool enabled;
+    static int topRow;
+    static std::map<int, Row> rows;     // 按行号缓存，只保留可见行附近的行
+    static SDL_Texture* letterTextures[FileBrowser::LETTER_COUNT];   // 首字母提示（按需创建）
+
+    static void follow(int selectedIndex, int count);
+    static Row& getRow(const FileListing& files, int index);
+    static void buildRow(Row& row, const FileListing& files, const FileEntry& entry);
+    static void destroyRow(Row& row);
+    static void evictRows();
+    static void drawLetterIndicator(FileBrowser* browser, int selectedIndex, int y);
+};
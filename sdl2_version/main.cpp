@@ -24,6 +24,13 @@
 #include "dsiUI.h"
 #include "resourceManager.h"
 #include "gameGrid.h"
+#include "ndsIconLoader.h"
+#include "romIO.h"
+#include "libraryIndex.h"
+#include "playHistory.h"
+#include "listView.h"
+#include "dirtyTracker.h"
+#include <algorithm>
 
 // 声明清理函数
 extern void graphicsCleanup();
@@ -39,6 +46,35 @@ extern SDL_Renderer* g_renderer;
 Menu* mainMenu = nullptr;
 extern FileBrowser* g_fileBrowser;
 
+// 设置菜单中排序方式的显示文本
+static std::string sortModeText() {
+    static const char* const names[FileBrowser::SORT_MODE_COUNT] = {"Name", "Title", "Size", "Date", "Play Count"};
+    return std::string("Sort By: ") + names[FileBrowser::parseSortMode(g_settings.sortMode)];
+}
+
+// 设置菜单中文件视图的显示文本
+static std::string viewModeText() {
+    return std::string("View: ") + (g_settings.viewMode == "list" ? "List" : "Grid");
+}
+
+// 采集决定屏幕内容的界面状态（与上一次绘制时比较）
+static void captureUIState(UIState& state) {
+    state.selectedIndex = GameGrid::getSelectedIndex();
+    state.scrollOffset = GameGrid::getScrollOffset();
+    state.listTopRow = ListView::getFirstVisible();
+    state.itemCount = g_fileBrowser ? (int)g_fileBrowser->getFiles().size() : 0;
+    state.keysHeld = InputManager::getState().keysHeld;
+    state.menuActive = mainMenu && mainMenu->isActive();
+    state.browserActive = g_fileBrowser && g_fileBrowser->isActive();
+    state.libraryMode = g_fileBrowser && g_fileBrowser->isLibraryMode();
+    state.listView = ListView::isEnabled() && g_fileBrowser && !state.libraryMode;
+    state.libraryUpdating = LibraryIndex::isUpdating();
+    state.clockMinute = (int64_t)g_settings.getAdjustedTime() / 60;
+    state.batteryLevel = std::min(DSiUI::getBatteryLevel() / 20, 4);
+    state.charging = DSiUI::isBatteryCharging();
+    state.chargeBlink = state.charging ? (SDL_GetTicks() / DirtyTracker::CHARGE_BLINK_MS) % 2 : 0;
+}
+
 // SDL2窗口和渲染器
 SDL_Window* window = nullptr;
 SDL_Renderer* renderer = nullptr;
@@ -131,6 +167,10 @@ void handleEvents() {
             case SDL_QUIT:
                 running = false;
                 break;
+            case SDL_WINDOWEVENT:
+                // 窗口显示、改变大小等：屏幕内容需要重绘
+                DirtyTracker::invalidate();
+                break;
             case SDL_KEYDOWN:
                 switch (e.key.keysym.sym) {
                     case SDLK_ESCAPE:
@@ -218,6 +258,30 @@ int main(int argc, char* argv[]) {
     // 加载设置
     g_settings.load();
     
+    // 应用缓存内存预算
+    NDSIconLoader::setMemoryBudget((size_t)g_settings.iconCacheBudgetKB * 1024);
+    ResourceManager::setMemoryBudget((size_t)g_settings.textureCacheBudgetKB * 1024);
+    TextRenderer::setCacheBudget((size_t)g_settings.textCacheBudgetKB * 1024);
+    
+    // 字体后端（第一次绘制文字时才加载字体）
+    TextRenderer::setBackend(g_settings.fontBackend == "nftr" ? FONT_BACKEND_NFTR : FONT_BACKEND_TTF);
+    
+    // 按键连发
+    InputManager::setKeyRepeat(g_settings.keyRepeatDelayMs, g_settings.keyRepeatIntervalMs,
+                               g_settings.keyRepeatMinIntervalMs, g_settings.keyRepeatAcceleration);
+    
+    // ROM元数据读取方式
+    RomIO::setMode(g_settings.romIOMode == "mmap" ? ROMIO_MMAP : ROMIO_PREAD);
+    
+    // 加载ROM库索引（进入ROM库模式时才在后台检查目录变化）
+    LibraryIndex::init(g_settings.libraryRoots);
+    
+    // 文件列表排序方式
+    if (g_fileBrowser) {
+        g_fileBrowser->setSortMode(FileBrowser::parseSortMode(g_settings.sortMode));
+    }
+    ListView::setEnabled(g_settings.viewMode == "list");
+    
     // 创建主菜单
     mainMenu = new Menu();
     mainMenu->addItem("File Browser", 1);
@@ -277,6 +341,8 @@ int main(int argc, char* argv[]) {
                             settingsMenu->addItem(topWallpaperText, 14);
                             settingsMenu->addItem(bottomWallpaperText, 15);
                             settingsMenu->addItem("Date & Time", 16);
+                            settingsMenu->addItem(sortModeText(), 17);
+                            settingsMenu->addItem(viewModeText(), 18);
                             settingsMenu->addItem("Save Settings", 12);
                             settingsMenu->addItem("Back", 13);
                             settingsMenu->setActive(true);
@@ -306,7 +372,7 @@ int main(int argc, char* argv[]) {
                                                         
                                                         if (InputManager::isKeyDown(KEY_A)) {
                                                             FileEntry* entry = g_fileBrowser->getSelectedEntry();
-                                                            if (entry && !entry->isDirectory) {
+                                                            if (entry && !entry->isDirectory()) {
                                                                 // 选择了PNG文件
                                                                 std::string selectedPath = g_fileBrowser->getSelectedFilePath();
                                                                 if (!selectedPath.empty()) {
@@ -341,6 +407,8 @@ int main(int argc, char* argv[]) {
                                                     settingsMenu->addItem(topWallpaperText, 14);
                                                     settingsMenu->addItem(bottomWallpaperText, 15);
                                                     settingsMenu->addItem("Date & Time", 16);
+                                                    settingsMenu->addItem(sortModeText(), 17);
+                                                    settingsMenu->addItem(viewModeText(), 18);
                                                     settingsMenu->addItem("Save Settings", 12);
                                                     settingsMenu->addItem("Back", 13);
                                                     settingsMenu->setActive(true);
@@ -365,7 +433,7 @@ int main(int argc, char* argv[]) {
                                                         
                                                         if (InputManager::isKeyDown(KEY_A)) {
                                                             FileEntry* entry = g_fileBrowser->getSelectedEntry();
-                                                            if (entry && !entry->isDirectory) {
+                                                            if (entry && !entry->isDirectory()) {
                                                                 // 选择了PNG文件
                                                                 std::string selectedPath = g_fileBrowser->getSelectedFilePath();
                                                                 if (!selectedPath.empty()) {
@@ -400,6 +468,8 @@ int main(int argc, char* argv[]) {
                                                     settingsMenu->addItem(topWallpaperText, 14);
                                                     settingsMenu->addItem(bottomWallpaperText, 15);
                                                     settingsMenu->addItem("Date & Time", 16);
+                                                    settingsMenu->addItem(sortModeText(), 17);
+                                                    settingsMenu->addItem(viewModeText(), 18);
                                                     settingsMenu->addItem("Save Settings", 12);
                                                     settingsMenu->addItem("Back", 13);
                                                     settingsMenu->setActive(true);
@@ -565,11 +635,43 @@ int main(int argc, char* argv[]) {
                                                 settingsMenu->addItem(topWallpaperText, 14);
                                                 settingsMenu->addItem(bottomWallpaperText, 15);
                                                 settingsMenu->addItem("Date & Time", 16);
+                                                settingsMenu->addItem(sortModeText(), 17);
+                                                settingsMenu->addItem(viewModeText(), 18);
                                                 settingsMenu->addItem("Save Settings", 12);
                                                 settingsMenu->addItem("Back", 13);
                                                 settingsMenu->setActive(true);
                                             }
                                             break;
+                                        case 17: // 切换文件排序方式
+                                        case 18: // 切换网格/列表视图
+                                            {
+                                                if (id == 17) {
+                                                    FileBrowser::SortMode mode = (FileBrowser::SortMode)
+                                                        ((FileBrowser::parseSortMode(g_settings.sortMode) + 1) % FileBrowser::SORT_MODE_COUNT);
+                                                    g_settings.sortMode = FileBrowser::getSortModeName(mode);
+                                                    if (g_fileBrowser) {
+                                                        g_fileBrowser->setSortMode(mode);
+                                                    }
+                                                } else {
+                                                    g_settings.viewMode = g_settings.viewMode == "list" ? "grid" : "list";
+                                                    ListView::setEnabled(g_settings.viewMode == "list");
+                                                }
+                                                
+                                                // 更新菜单显示（保持选中项）
+                                                int menuIndex = settingsMenu->getSelectedIndex();
+                                                settingsMenu->clear();
+                                                topWallpaperText = std::string("Top Wallpaper: ") + (g_settings.topWallpaperPath.empty() ? "Default" : "Custom");
+                                                bottomWallpaperText = std::string("Bottom Wallpaper: ") + (g_settings.bottomWallpaperPath.empty() ? "Default" : "Custom");
+                                                settingsMenu->addItem(topWallpaperText, 14);
+                                                settingsMenu->addItem(bottomWallpaperText, 15);
+                                                settingsMenu->addItem("Date & Time", 16);
+                                                settingsMenu->addItem(sortModeText(), 17);
+                                                settingsMenu->addItem(viewModeText(), 18);
+                                                settingsMenu->addItem("Save Settings", 12);
+                                                settingsMenu->addItem("Back", 13);
+                                                settingsMenu->setSelectedIndex(menuIndex);
+                                            }
+                                            break;
                                         case 12:
                                             g_settings.save();
                                             std::cout << "Settings saved" << std::endl;
@@ -594,6 +696,7 @@ int main(int argc, char* argv[]) {
                             }
                             
                             delete settingsMenu;
+                            DirtyTracker::invalidate();
                             mainMenu->setActive(false);
                         }
                         break;
@@ -620,39 +723,60 @@ int main(int argc, char* argv[]) {
         
         // 处理游戏网格导航（当菜单和文件浏览器都不活动时）
         if ((!mainMenu || !mainMenu->isActive()) && (!g_fileBrowser || !g_fileBrowser->isActive())) {
-            GameGrid::update();
+            // 列表视图用上/下移动；ROM库模式中上/下用于选择搜索字符，仍然用左右键移动
+            if (ListView::isEnabled() && g_fileBrowser && !g_fileBrowser->isLibraryMode()) {
+                ListView::update(g_fileBrowser);
+            } else {
+                GameGrid::update(g_fileBrowser);
+            }
+            
+            // SELECT键切换ROM库模式：在所有ROM根目录中按标题搜索（上/下选择字符，Y输入，X删除）
+            if (g_fileBrowser && InputManager::isKeyDown(KEY_SELECT)) {
+                g_fileBrowser->setLibraryMode(!g_fileBrowser->isLibraryMode());
+                GameGrid::setMaxItems(g_fileBrowser->getFiles().size());
+                GameGrid::setSelectedIndex(g_fileBrowser->getSelectedIndex());
+            } else if (g_fileBrowser && g_fileBrowser->handleLibraryInput()) {
+                GameGrid::setMaxItems(g_fileBrowser->getFiles().size());
+                GameGrid::setSelectedIndex(g_fileBrowser->getSelectedIndex());
+            }
             
             // 处理A键或Start键按下：进入文件夹或启动NDS文件
             if (InputManager::isKeyDown(KEY_A) || InputManager::isKeyDown(KEY_START)) {
                 if (g_fileBrowser) {
                     int selectedIndex = GameGrid::getSelectedIndex();
-                    const std::vector<FileEntry>& fileList = g_fileBrowser->getFiles();
+                    const FileListing& fileList = g_fileBrowser->getFiles();
                     
                     if (selectedIndex >= 0 && selectedIndex < (int)fileList.size()) {
                         const FileEntry& entry = fileList[selectedIndex];
                         
-                        if (entry.isDirectory) {
-                            // 进入文件夹
-                            std::string dirPath = entry.path;
-                            if (entry.isParent) {
+                        if (entry.isDirectory()) {
+                            // 进入文件夹（离开前记住网格的选中位置，保存在目录快照中）
+                            g_fileBrowser->setSelectedIndex(selectedIndex);
+                            if (entry.isParent()) {
                                 // 返回上一级目录
                                 g_fileBrowser->goUp();
                             } else {
                                 // 进入子目录
-                                g_fileBrowser->enterDirectory(entry.name);
+                                std::string dirName = fileList.getName(entry);
+                                g_fileBrowser->enterDirectory(dirName);
                             }
-                            // 重置选中索引
-                            GameGrid::setSelectedIndex(0);
+                            // 恢复该目录上次的选中位置（新扫描的目录为0）
+                            GameGrid::setMaxItems(g_fileBrowser->getFiles().size());
+                            GameGrid::setSelectedIndex(g_fileBrowser->getSelectedIndex());
                             std::cout << "进入文件夹: " << g_fileBrowser->getCurrentPath() << std::endl;
-                        } else if (DSiUI::isNDSFile(entry.name)) {
+                        } else if (entry.type == FILE_TYPE_NDS) {
                             // 启动NDS文件
-                            std::string ndsPath = entry.path;
+                            std::string ndsPath = fileList.getPath(entry);
                             // 获取绝对路径
                             char* absPath = realpath(ndsPath.c_str(), nullptr);
                             if (absPath) {
                                 std::string absolutePath = absPath;
                                 free(absPath);
                                 
+                                // 记录启动次数（按游玩次数排序）：与读取时一样使用列表中的路径，
+                                // 不解析符号链接，否则通过链接目录启动的游戏查不到次数
+                                PlayHistory::recordLaunch(ndsPath);
+                                
                                 // 关闭背景音乐
                                 stopBackgroundMusic();
                                 
@@ -681,8 +805,10 @@ int main(int argc, char* argv[]) {
                                     mainMenu = nullptr;
                                 }
                                 InputManager::cleanup();
+                                DirtyTracker::cleanup();
                                 graphicsCleanup();
                                 fontCleanup();
+                                LibraryIndex::cleanup();
                                 fileBrowseCleanup();
                                 languageCleanup();
                                 soundCleanup();
@@ -719,6 +845,29 @@ int main(int argc, char* argv[]) {
         // 更新游戏逻辑
         updateFrame(true);
 
+        // 画面没有变化时跳过绘制和呈现，阻塞等待下一个输入事件或定时变化
+        UIState uiState;
+        captureUIState(uiState);
+        InputState input = InputManager::getState();
+        bool inputActive = input.keysDown || input.keysUp || input.keysRepeat ||
+                           input.touchDown || input.touchReleased;
+        if (g_settings.showFPS || DirtyTracker::isGridAnimating(uiState)) {
+            // 显示FPS时每帧都绘制；网格滚动动画进行中（列表视图中网格不更新动画，不计入）
+            DirtyTracker::invalidate();
+        }
+        if (!DirtyTracker::shouldRender(uiState, inputActive)) {
+            Uint32 timeout = DirtyTracker::getIdleTimeout(g_settings.getAdjustedTime(), uiState.charging);
+            // 按住按键（等待连发）或后台还在读取图标、扫描目录时按帧间隔检查，否则一直睡到下一次定时变化
+            bool busy = input.keysHeld != 0 || NDSIconLoader::hasPendingWork() || LibraryIndex::isUpdating() ||
+                        (g_fileBrowser && g_fileBrowser->isScanning());
+            if (busy) {
+                timeout = std::min(timeout, frameTime);
+            }
+            SDL_WaitEventTimeout(nullptr, timeout);
+            lastTime = currentTime;
+            continue;
+        }
+
         // 渲染
         SDL_RenderClear(renderer);
         renderFrame();
@@ -775,8 +924,10 @@ int main(int argc, char* argv[]) {
         mainMenu = nullptr;
     }
     InputManager::cleanup();
+    DirtyTracker::cleanup();
     graphicsCleanup();
     fontCleanup();
+    LibraryIndex::cleanup();
     fileBrowseCleanup();
     languageCleanup();
     soundCleanup();
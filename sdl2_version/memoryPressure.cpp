@@ -0,0 +1,37 @@
+#include "memoryPressure.h"
+#include <SDL2/SDL.h>
+#include <cstdio>
+
+float MemoryPressure::threshold = 10.0f;
+unsigned int MemoryPressure::lastCheckTime = 0;
+
+// 两次检查之间的最小间隔（毫秒）
+static const unsigned int CHECK_INTERVAL_MS = 2000;
+
+bool MemoryPressure::readSomeAvg10(const char* path, float& avg10) {
+    FILE* fp = fopen(path, "r");
+    if (!fp) {
+        return false;
+    }
+
+    // 格式：some avg10=0.00 avg60=0.00 avg300=0.00 total=0
+    bool ok = fscanf(fp, "some avg10=%f", &avg10) == 1;
+    fclose(fp);
+    return ok;
+}
+
+bool MemoryPressure::poll() {
+    unsigned int now = SDL_GetTicks();
+    if (lastCheckTime != 0 && now - lastCheckTime < CHECK_INTERVAL_MS) {
+        return false;
+    }
+    lastCheckTime = now;
+
+    float avg10 = 0.0f;
+    if (!readSomeAvg10("/sys/fs/cgroup/memory.pressure", avg10) &&
+        !readSomeAvg10("/proc/pressure/memory", avg10)) {
+        return false;  // 内核不支持PSI
+    }
+
+    return avg10 >= threshold;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// 内存压力检测（Linux PSI）：优先读取cgroup v2的memory.pressure，
+// 否则读取系统级的/proc/pressure/memory
+class MemoryPressure {
+public:
+    // 定期检查（内部限制读取频率），内存压力超过阈值时返回true
+    static bool poll();
+
+    // 设置阈值（"some avg10"百分比）
+    static void setThreshold(float percent) { threshold = percent; }
+
+private:
+    static float threshold;
+    static unsigned int lastCheckTime;
+    static bool readSomeAvg10(const char* path, float& avg10);
+};
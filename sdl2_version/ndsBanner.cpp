@@ -0,0 +1,328 @@
+#include "ndsBanner.h"
+#include "fileTypes.h"
+#include "romIO.h"
+#include <cstring>
+#include <array>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+
+// NDS文件头中用到的字段偏移
+static const u32 HEADER_GAMECODE_OFFSET = 0x0C;
+static const u32 HEADER_BANNER_OFFSET = 0x68;
+static const u32 HEADER_READ_SIZE = 0x6C;
+
+// Banner中各字段的偏移
+static const u32 BANNER_CRC_OFFSET = 0x02;
+static const u32 BANNER_ICON_OFFSET = 0x20;
+static const u32 BANNER_PALETTE_OFFSET = 0x220;
+static const u32 BANNER_TITLES_OFFSET = 0x240;
+static const u32 BANNER_ANIMATION_OFFSET = 0x1240;
+
+// 根据Banner版本返回包含的标题数量
+static int titleCountForVersion(u16 version) {
+    if (version >= BANNER_VERSION_KOREAN) return 8;
+    if (version == BANNER_VERSION_CHINESE) return 7;
+    return 6;
+}
+
+// 根据Banner版本返回静态部分（不含DSi动画）的大小
+static u32 staticSizeForVersion(u16 version) {
+    if (version >= BANNER_VERSION_KOREAN) return BANNER_SIZE_KOREAN;
+    if (version == BANNER_VERSION_CHINESE) return BANNER_SIZE_CHINESE;
+    return BANNER_SIZE_ORIGINAL;
+}
+
+bool isNDSFileName(const std::string& fileName) {
+    // NDS扩展名列表在fileTypes.cpp的扩展名表中
+    return classifyFileName(fileName.c_str()) == FILE_TYPE_NDS;
+}
+
+bool readNDSBannerInfo(const std::string& filePath, NDSBannerInfo& info) {
+    // 只读取文件头和Banner两段范围，不经过stdio缓冲，也不触发预读
+    RomFile rom;
+    if (!rom.open(filePath)) {
+        return false;
+    }
+    const u32 fileSize = rom.size() > 0xFFFFFFFF ? 0xFFFFFFFF : (u32)rom.size();
+
+    // 读取文件头（游戏代码和Banner偏移）
+    u8 header[HEADER_READ_SIZE];
+    if (!rom.readAt(0, header, sizeof(header))) {
+        return false;
+    }
+
+    u32 bannerOffset;
+    memcpy(info.gameCode, header + HEADER_GAMECODE_OFFSET, 4);
+    memcpy(&bannerOffset, header + HEADER_BANNER_OFFSET, 4);
+
+    // Banner至少需要原始版本的大小
+    if (bannerOffset == 0 || bannerOffset > fileSize || fileSize - bannerOffset < BANNER_SIZE_ORIGINAL) {
+        return false;
+    }
+
+    // 一次读取静态部分（最多到韩文标题），不超过文件末尾
+    u8 banner[BANNER_SIZE_KOREAN];
+    u32 available = fileSize - bannerOffset;
+    u32 readSize = available < (u32)BANNER_SIZE_KOREAN ? available : (u32)BANNER_SIZE_KOREAN;
+    if (!rom.readAt(bannerOffset, banner, readSize)) {
+        return false;
+    }
+
+    memcpy(&info.version, banner, 2);
+    memcpy(info.crc, banner + BANNER_CRC_OFFSET, sizeof(info.crc));
+    memcpy(info.icon, banner + BANNER_ICON_OFFSET, sizeof(info.icon));
+    memcpy(info.palette, banner + BANNER_PALETTE_OFFSET, sizeof(info.palette));
+
+    // 只复制该版本实际包含且已读取的标题，其余保持为空
+    memset(info.titles, 0, sizeof(info.titles));
+    int titleCount = titleCountForVersion(info.version);
+    if (staticSizeForVersion(info.version) > readSize) {
+        titleCount = 6;
+    }
+    memcpy(info.titles, banner + BANNER_TITLES_OFFSET, titleCount * sizeof(info.titles[0]));
+
+    // DSi动画图标（版本0x0103且文件中确实存在完整数据）
+    // 图标、调色板和序列在文件中连续存放，与NDSBannerAnimation布局一致，一次读取
+    info.animation.reset();
+    if (info.version == BANNER_VERSION_DSI && available >= BANNER_SIZE_DSI) {
+        static_assert(sizeof(NDSBannerAnimation) == BANNER_SIZE_DSI - BANNER_ANIMATION_OFFSET,
+                      "NDSBannerAnimation必须与文件中的动画数据布局一致");
+        std::unique_ptr<NDSBannerAnimation> animation(new NDSBannerAnimation());
+        if (rom.readAt(bannerOffset + BANNER_ANIMATION_OFFSET, animation.get(), sizeof(NDSBannerAnimation))) {
+            info.animation = std::move(animation);
+        }
+    }
+
+    return true;
+}
+
+// NDS图标是tile格式：4x4个8x8像素的tile，每个tile的一行占4字节（8个4位像素）。
+// 这里把128个源行映射到32x32线性图像中的像素偏移，解码时按行直接写到目标位置，
+// 不再需要先转换成线性数据
+static constexpr int ICON_TILE_ROWS = 128;
+
+static constexpr std::array<u16, ICON_TILE_ROWS> makeIconRowOffsets() {
+    std::array<u16, ICON_TILE_ROWS> offsets = {};
+    for (int row = 0; row < ICON_TILE_ROWS; row++) {
+        int tile = row / 8;
+        int tileX = tile % 4;
+        int tileY = tile / 4;
+        int pY = row % 8;
+        offsets[row] = (u16)((tileY * 8 + pY) * 32 + tileX * 8);
+    }
+    return offsets;
+}
+
+static constexpr std::array<u16, ICON_TILE_ROWS> ICON_ROW_OFFSETS = makeIconRowOffsets();
+
+void buildNDSIconLUT(const u16* palette, u32* lut) {
+    for (int i = 0; i < 16; i++) {
+        // RGB15格式：位0-4=红色，位5-9=绿色，位10-14=蓝色，位15未使用
+        u16 rgb15 = palette[i];
+        u32 r = ((rgb15 >> 0) & 31) << 3;
+        u32 g = ((rgb15 >> 5) & 31) << 3;
+        u32 b = ((rgb15 >> 10) & 31) << 3;
+
+        // 索引0且颜色为0时为透明
+        u32 a = (i == 0 && rgb15 == 0) ? 0 : 255;
+        lut[i] = (a << 24) | (b << 16) | (g << 8) | r;
+    }
+}
+
+// 标量版本：没有NEON/SSSE3时使用，也用于和向量版本对照
+static void expandIconRowsScalar(const u8* iconData, const u32* lut, u32* pixels) {
+    for (int row = 0; row < ICON_TILE_ROWS; row++) {
+        const u8* src = iconData + row * 4;
+        u32* dst = pixels + ICON_ROW_OFFSETS[row];
+        // 每字节两个像素，低4位在左
+        for (int i = 0; i < 4; i++) {
+            dst[i * 2] = lut[src[i] & 0x0F];
+            dst[i * 2 + 1] = lut[src[i] >> 4];
+        }
+    }
+}
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+
+// NEON：调色板拆成R/G/B/A四个16字节平面，用tbl按4位索引查表，
+// vst4交织写出RGBA，每次处理tile中的两行（16个像素）
+static void expandIconRows(const u8* iconData, const u32* lut, u32* pixels) {
+    u8 planes[4][16];
+    for (int i = 0; i < 16; i++) {
+        planes[0][i] = (u8)(lut[i]);
+        planes[1][i] = (u8)(lut[i] >> 8);
+        planes[2][i] = (u8)(lut[i] >> 16);
+        planes[3][i] = (u8)(lut[i] >> 24);
+    }
+    uint8x16_t r = vld1q_u8(planes[0]);
+    uint8x16_t g = vld1q_u8(planes[1]);
+    uint8x16_t b = vld1q_u8(planes[2]);
+    uint8x16_t a = vld1q_u8(planes[3]);
+    uint8x8_t nibbleMask = vdup_n_u8(0x0F);
+
+    for (int row = 0; row < ICON_TILE_ROWS; row += 2) {
+        uint8x8_t src = vld1_u8(iconData + row * 4);
+        // 低4位是左边的像素：交错后前8个索引是第一行，后8个是第二行
+        uint8x8x2_t idx = vzip_u8(vand_u8(src, nibbleMask), vshr_n_u8(src, 4));
+        for (int half = 0; half < 2; half++) {
+            uint8x8x4_t rgba;
+            rgba.val[0] = vqtbl1_u8(r, idx.val[half]);
+            rgba.val[1] = vqtbl1_u8(g, idx.val[half]);
+            rgba.val[2] = vqtbl1_u8(b, idx.val[half]);
+            rgba.val[3] = vqtbl1_u8(a, idx.val[half]);
+            vst4_u8((u8*)(pixels + ICON_ROW_OFFSETS[row + half]), rgba);
+        }
+    }
+}
+
+#elif defined(__SSSE3__)
+
+// SSSE3：与NEON相同的平面查表方式，用pshufb查表，unpack交织为RGBA
+// （SSE2没有字节查表指令，只有SSE2时使用标量版本）
+static void expandIconRows(const u8* iconData, const u32* lut, u32* pixels) {
+    alignas(16) u8 planes[4][16];
+    for (int i = 0; i < 16; i++) {
+        planes[0][i] = (u8)(lut[i]);
+        planes[1][i] = (u8)(lut[i] >> 8);
+        planes[2][i] = (u8)(lut[i] >> 16);
+        planes[3][i] = (u8)(lut[i] >> 24);
+    }
+    __m128i r = _mm_load_si128((const __m128i*)planes[0]);
+    __m128i g = _mm_load_si128((const __m128i*)planes[1]);
+    __m128i b = _mm_load_si128((const __m128i*)planes[2]);
+    __m128i a = _mm_load_si128((const __m128i*)planes[3]);
+    __m128i nibbleMask = _mm_set1_epi8(0x0F);
+
+    for (int row = 0; row < ICON_TILE_ROWS; row += 2) {
+        __m128i src = _mm_loadl_epi64((const __m128i*)(iconData + row * 4));
+        __m128i lo = _mm_and_si128(src, nibbleMask);
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(src, 4), nibbleMask);
+        // 前8个索引是第一行，后8个是第二行
+        __m128i idx = _mm_unpacklo_epi8(lo, hi);
+
+        __m128i rv = _mm_shuffle_epi8(r, idx);
+        __m128i gv = _mm_shuffle_epi8(g, idx);
+        __m128i bv = _mm_shuffle_epi8(b, idx);
+        __m128i av = _mm_shuffle_epi8(a, idx);
+
+        __m128i rgLo = _mm_unpacklo_epi8(rv, gv);
+        __m128i baLo = _mm_unpacklo_epi8(bv, av);
+        __m128i rgHi = _mm_unpackhi_epi8(rv, gv);
+        __m128i baHi = _mm_unpackhi_epi8(bv, av);
+
+        __m128i* dst0 = (__m128i*)(pixels + ICON_ROW_OFFSETS[row]);
+        __m128i* dst1 = (__m128i*)(pixels + ICON_ROW_OFFSETS[row + 1]);
+        _mm_storeu_si128(dst0, _mm_unpacklo_epi16(rgLo, baLo));
+        _mm_storeu_si128(dst0 + 1, _mm_unpackhi_epi16(rgLo, baLo));
+        _mm_storeu_si128(dst1, _mm_unpacklo_epi16(rgHi, baHi));
+        _mm_storeu_si128(dst1 + 1, _mm_unpackhi_epi16(rgHi, baHi));
+    }
+}
+
+#else
+
+static void expandIconRows(const u8* iconData, const u32* lut, u32* pixels) {
+    expandIconRowsScalar(iconData, lut, pixels);
+}
+
+#endif
+
+void decodeNDSIcon(const u8* iconData, const u16* palette, u32* pixels) {
+    u32 lut[16];
+    buildNDSIconLUT(palette, lut);
+    expandIconRows(iconData, lut, pixels);
+}
+
+void decodeNDSIconScalar(const u8* iconData, const u16* palette, u32* pixels) {
+    u32 lut[16];
+    buildNDSIconLUT(palette, lut);
+    expandIconRowsScalar(iconData, lut, pixels);
+}
+
+bool compileNDSIconAnimation(const NDSBannerAnimation& animation, NDSIconAnimation& compiled) {
+    compiled.images.clear();
+    compiled.steps.clear();
+    compiled.totalDuration = 0;
+
+    for (int i = 0; i < 64; i++) {
+        u16 entry = animation.sequence[i];
+        u8 duration = entry & 0xFF;
+        if (duration == 0) {
+            break;  // 序列结束
+        }
+
+        u8 bitmap = (entry >> 8) & 7;
+        u8 palette = (entry >> 11) & 7;
+
+        // 相同的位图和调色板组合共用一张图像
+        size_t image = 0;
+        while (image < compiled.images.size() &&
+               (compiled.images[image].bitmap != bitmap || compiled.images[image].palette != palette)) {
+            image++;
+        }
+        if (image == compiled.images.size()) {
+            compiled.images.push_back({bitmap, palette});
+        }
+
+        NDSIconAnimation::Step step;
+        step.image = (u8)image;
+        step.duration = duration;
+        step.hflip = (entry >> 14) & 1;
+        step.vflip = (entry >> 15) & 1;
+        compiled.steps.push_back(step);
+        compiled.totalDuration += duration;
+    }
+
+    return !compiled.steps.empty();
+}
+
+void decodeNDSIconAnimation(const NDSBannerAnimation& animation, const NDSIconAnimation& compiled, u32* pixels) {
+    for (size_t i = 0; i < compiled.images.size(); i++) {
+        const NDSIconAnimation::Image& image = compiled.images[i];
+        decodeNDSIcon(animation.icons[image.bitmap], animation.palettes[image.palette], pixels + i * 32 * 32);
+    }
+}
+
+std::string utf16ToUtf8(const u16* utf16, size_t maxLen) {
+    std::string result;
+    for (size_t i = 0; i < maxLen && utf16[i] != 0; i++) {
+        u16 code = utf16[i];
+        if (code < 0x80) {
+            result += (char)code;
+        } else if (code < 0x800) {
+            result += (char)(0xC0 | (code >> 6));
+            result += (char)(0x80 | (code & 0x3F));
+        } else {
+            result += (char)(0xE0 | (code >> 12));
+            result += (char)(0x80 | ((code >> 6) & 0x3F));
+            result += (char)(0x80 | (code & 0x3F));
+        }
+    }
+    return result;
+}
+
+std::string selectNDSTitle(const u16 titles[][128], int langIndex) {
+    // 限制语言索引范围
+    if (langIndex < 0) langIndex = 0;
+    if (langIndex >= TITLE_LANGUAGE_COUNT) langIndex = TITLE_LANGUAGE_COUNT - 1;
+
+    // 选择标题语言（优先使用指定语言，如果为空则尝试其他语言）
+    int currentLang = langIndex;
+    while (currentLang >= 0 &&
+           (titles[currentLang][0] == 0 ||
+            (titles[currentLang][0] == 0x20 && titles[currentLang][1] == 0))) {
+        currentLang--;
+    }
+
+    if (currentLang < 0) {
+        // 如果所有语言都为空，返回空字符串
+        return "";
+    }
+
+    // 转换UTF-16到UTF-8
+    return utf16ToUtf8(titles[currentLang], 128);
+}
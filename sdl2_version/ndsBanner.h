@@ -0,0 +1,105 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+// 类型定义
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+
+// Banner版本
+enum NDSBannerVersion {
+    BANNER_VERSION_ORIGINAL = 0x0001,  // 6种语言
+    BANNER_VERSION_CHINESE  = 0x0002,  // 增加中文标题
+    BANNER_VERSION_KOREAN   = 0x0003,  // 增加韩文标题
+    BANNER_VERSION_DSI      = 0x0103   // 增加DSi动画图标
+};
+
+// 各版本Banner的大小
+enum NDSBannerSize {
+    BANNER_SIZE_ORIGINAL = 0x0840,
+    BANNER_SIZE_CHINESE  = 0x0940,
+    BANNER_SIZE_KOREAN   = 0x0A40,
+    BANNER_SIZE_DSI      = 0x23C0
+};
+
+// 标题语言索引
+enum NDSTitleLanguage {
+    TITLE_JAPANESE = 0,
+    TITLE_ENGLISH,
+    TITLE_FRENCH,
+    TITLE_GERMAN,
+    TITLE_ITALIAN,
+    TITLE_SPANISH,
+    TITLE_CHINESE,
+    TITLE_KOREAN,
+    TITLE_LANGUAGE_COUNT
+};
+
+// DSi动画图标数据（仅版本0x0103存在）
+struct NDSBannerAnimation {
+    u8 icons[8][512];      // 8张4bpp图标
+    u16 palettes[8][16];   // 8组调色板
+    u16 sequence[64];      // 动画序列
+};
+
+// 编译后的DSi动画序列：
+// images为用到的(位图, 调色板)组合，每个组合只解码一次；
+// steps为播放步骤，引用images中的下标
+struct NDSIconAnimation {
+    struct Image {
+        u8 bitmap;
+        u8 palette;
+    };
+    struct Step {
+        u8 image;       // images中的下标
+        u8 duration;    // 持续帧数（60fps）
+        bool hflip;
+        bool vflip;
+    };
+    std::vector<Image> images;
+    std::vector<Step> steps;
+    u32 totalDuration;  // 一轮播放的总帧数
+};
+
+// 一次读取解析的NDS Banner记录（图标和标题共用）
+struct NDSBannerInfo {
+    char gameCode[4];
+    u16 version;
+    u16 crc[4];
+    u8 icon[512];          // 32x32图标，4位每像素（tile格式）
+    u16 palette[16];       // 16色调色板
+    u16 titles[TITLE_LANGUAGE_COUNT][128];  // 8种语言的标题（不存在的语言为空）
+    std::unique_ptr<NDSBannerAnimation> animation;  // DSi动画（可能为空）
+};
+
+// 编译DSi动画序列（位0-7持续帧数，8-10位图，11-13调色板，14水平翻转，15垂直翻转，
+// 持续帧数为0表示序列结束），序列为空时返回false
+bool compileNDSIconAnimation(const NDSBannerAnimation& animation, NDSIconAnimation& compiled);
+
+// 按编译后的序列解码所有用到的图像（每张32x32 RGBA，依次存放）
+void decodeNDSIconAnimation(const NDSBannerAnimation& animation, const NDSIconAnimation& compiled, u32* pixels);
+
+// 是否为NDS/DSi ROM文件名（按扩展名判断，不区分大小写）
+bool isNDSFileName(const std::string& fileName);
+
+// 从NDS文件读取Banner（一次打开，按版本进行带边界检查的读取）
+bool readNDSBannerInfo(const std::string& filePath, NDSBannerInfo& info);
+
+// 将RGB15调色板转换为16项RGBA查找表（索引0且颜色为0时透明）
+void buildNDSIconLUT(const u16* palette, u32* lut);
+
+// 将4位tile格式的图标数据直接解码为32x32 RGBA像素（查表，支持NEON/SSSE3）
+void decodeNDSIcon(const u8* iconData, const u16* palette, u32* pixels);
+
+// decodeNDSIcon的标量版本（结果相同，供icon_bench对照）
+void decodeNDSIconScalar(const u8* iconData, const u16* palette, u32* pixels);
+
+// 选择标题语言（指定语言为空时向前回退），返回UTF-8标题，全部为空时返回空字符串
+std::string selectNDSTitle(const u16 titles[][128], int langIndex);
+
+// UTF-16转UTF-8
+std::string utf16ToUtf8(const u16* utf16, size_t maxLen);
@@ -3,29 +3,19 @@
 #include <SDL2/SDL.h>
 #include <string>
 #include <map>
+#include <set>
 #include <cstdint>
+#include "ndsBanner.h"
+#include "bannerCache.h"
+#include "bannerWorker.h"
+#include "iconAtlas.h"
+#include "cacheStats.h"
 
-// 类型定义
-typedef uint8_t u8;
-typedef uint16_t u16;
-typedef uint32_t u32;
-
-// NDS文件头结构（简化版）
-struct NDSHeader {
-    char gameTitle[12];
-    char gameCode[4];
-    u8 reserved[0x9C];
-    u32 bannerOffset;  // Banner数据偏移
-};
-
-// NDS Banner结构（包含图标和标题）
-struct NDSBanner {
-    u16 version;
-    u16 crc[4];
-    u8 reserved[22];
-    u8 icon[512];      // 32x32图标，4位每像素
-    u16 palette[16];   // 16色调色板
-    u16 titles[8][128]; // 8种语言的标题
+// 异步读取Banner元数据的状态
+enum NDSMetadataState {
+    NDS_METADATA_PENDING,  // 后台读取中
+    NDS_METADATA_READY,    // 已读取
+    NDS_METADATA_FAILED    // 没有可用的Banner
 };
 
 // NDS图标加载器
@@ -34,26 +24,64 @@ public:
     static void init(SDL_Renderer* renderer);
     static void cleanup();
     
-    // 从NDS文件加载图标
-    static SDL_Texture* loadIconFromNDS(const std::string& filePath);
+    // 从NDS文件加载图标，返回图集句柄（异步：尚未解码完成时返回false，调用者显示占位图标）
+    // DSi动画图标返回当前帧的位置和翻转方式，调用者按handle.flip绘制
+    static bool loadIconFromNDS(const std::string& filePath, IconHandle& handle);
+    
+    // 处理后台解码完成的图标，每帧最多上传maxUploads个纹理（主线程调用）
+    static void processCompletedIcons(int maxUploads = 4);
+    
+    // 是否还有后台读取中或等待上传的图标（主循环空闲时据此决定等待多久）
+    static bool hasPendingWork() { return !pendingIcons.empty() || completedIcons != nullptr; }
     
     // 从NDS文件读取标题（UTF-16转UTF-8）
     static std::string loadTitleFromNDS(const std::string& filePath, int langIndex = 1);
     
+    // 异步读取标题和文件大小：缓存中已有时直接返回，否则与图标一起交给后台线程读取
+    static NDSMetadataState requestTitle(const std::string& filePath, int langIndex, std::string& title, uint64_t& size);
+    
+    // 快速滚动时调用：丢弃排队中还没开始解码的请求（已经滚出屏幕的图标）
+    // 仍然可见的图标在下一次绘制时重新请求
+    static void cancelQueuedRequests();
+    
     // 清除缓存
     static void clearCache();
     
+    // 文件被修改：丢弃已上传的图标和失败记录，下次显示时重新读取
+    static void invalidate(const std::string& filePath);
+    
+    // 图标缓存的显存预算（字节），决定图集最多使用的页数
+    static void setMemoryBudget(size_t bytes);
+    
+    // 内存压力时释放图集页（只保留一页）
+    static void trim();
+    
+    static const CacheStats& getStats();
+    
 private:
+    // 已上传的图标：静态图标槽位，以及DSi动画的帧槽位和播放序列
+    struct CachedIcon {
+        int slot;
+        std::vector<int> frameSlots;                    // 对应animation.images
+        std::vector<NDSIconAnimation::Step> steps;
+        u32 totalDuration;
+    };
+    
     static SDL_Renderer* renderer;
-    static std::map<std::string, SDL_Texture*> iconCache;
+    static std::map<std::string, CachedIcon> iconCache; // 路径 -> 图集槽位
+    static std::set<std::string> pendingIcons;          // 已投递、尚未上传的图标
+    static BannerJobResult* completedIcons;             // 已完成、等待上传的结果
+    static CacheStats stats;
+    
+    // 从缓存中移除被图集淘汰的图标
+    static void forgetEvicted(const std::vector<std::string>& evicted);
     
-    // 将4位图标数据转换为RGBA纹理
-    static SDL_Texture* convertIconToTexture(const u8* iconData, const u16* palette);
+    // 移除一个图标并释放它的其余槽位（reusedSlot已被图集复用，不再释放）
+    static void forgetIcon(const std::string& filePath, int reusedSlot);
     
-    // 读取NDS文件头
-    static bool readNDSHeader(FILE* fp, NDSHeader& header);
+    // 上传一个后台解析结果到图集
+    static void uploadIcon(BannerJobResult* result);
     
-    // 读取Banner数据
-    static bool readBanner(FILE* fp, u32 bannerOffset, NDSBanner& banner);
+    // 获取Banner缓存条目（未命中时一次读取ROM的Banner并写入缓存）
+    static const BannerCacheEntry* loadCacheEntry(const std::string& filePath);
 };
-
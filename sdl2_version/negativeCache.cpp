@@ -0,0 +1,62 @@
+#include "negativeCache.h"
+#include <SDL2/SDL.h>
+#include <sys/stat.h>
+
+std::map<std::string, NegativeCache::Entry> NegativeCache::entries;
+
+// 重试间隔：从1秒开始，文件一直没有变化时逐步加倍到30秒
+static const unsigned int MIN_RETRY_MS = 1000;
+static const unsigned int MAX_RETRY_MS = 30000;
+
+void NegativeCache::statPath(const std::string& path, int64_t& mtime, uint64_t& size) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        mtime = -1;
+        size = 0;
+        return;
+    }
+    mtime = (int64_t)st.st_mtime;
+    size = (uint64_t)st.st_size;
+}
+
+bool NegativeCache::shouldSkip(const std::string& path) {
+    auto it = entries.find(path);
+    if (it == entries.end()) {
+        return false;
+    }
+
+    Entry& entry = it->second;
+    unsigned int now = SDL_GetTicks();
+    if ((int)(entry.nextCheck - now) > 0) {
+        return true;
+    }
+
+    // 间隔到期：文件没有变化就继续跳过，否则允许重新加载
+    int64_t mtime;
+    uint64_t size;
+    statPath(path, mtime, size);
+    if (mtime == entry.mtime && size == entry.size) {
+        entry.interval = entry.interval * 2 > MAX_RETRY_MS ? MAX_RETRY_MS : entry.interval * 2;
+        entry.nextCheck = now + entry.interval;
+        return true;
+    }
+
+    entries.erase(it);
+    return false;
+}
+
+void NegativeCache::recordFailure(const std::string& path) {
+    Entry entry;
+    statPath(path, entry.mtime, entry.size);
+    entry.interval = MIN_RETRY_MS;
+    entry.nextCheck = SDL_GetTicks() + entry.interval;
+    entries[path] = entry;
+}
+
+void NegativeCache::forget(const std::string& path) {
+    entries.erase(path);
+}
+
+void NegativeCache::clear() {
+    entries.clear();
+}
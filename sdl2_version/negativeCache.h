@@ -0,0 +1,33 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <cstdint>
+
+// 加载失败记录：按路径记录失败时文件的mtime/大小，
+// 在重试间隔内直接跳过，间隔到期后只stat一次，文件未变化则继续跳过（间隔加倍）
+// 只在主线程使用
+class NegativeCache {
+public:
+    // 该路径最近加载失败且文件未变化时返回true（调用者应跳过加载）
+    static bool shouldSkip(const std::string& path);
+
+    // 记录加载失败
+    static void recordFailure(const std::string& path);
+
+    // 清除记录（文件被替换或设置改变时）
+    static void forget(const std::string& path);
+    static void clear();
+
+private:
+    struct Entry {
+        int64_t mtime;          // 失败时文件的修改时间（文件不存在为-1）
+        uint64_t size;
+        unsigned int nextCheck; // 下次检查文件状态的时间（SDL_GetTicks）
+        unsigned int interval;  // 当前重试间隔（毫秒）
+    };
+
+    static std::map<std::string, Entry> entries;
+
+    static void statPath(const std::string& path, int64_t& mtime, uint64_t& size);
+};
@@ -0,0 +1,67 @@
+#include "playHistory.h"
+#include "bannerCache.h"
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+std::string PlayHistory::historyPath = "playcount.ini";
+std::map<std::string, int> PlayHistory::counts;
+bool PlayHistory::loaded = false;
+
+void PlayHistory::load() {
+    loaded = true;
+
+    std::ifstream file(historyPath);
+    if (!file.is_open()) {
+        return;  // 还没有启动记录
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        // 路径中可能包含'='，次数在最后一个'='之后
+        size_t pos = line.rfind('=');
+        if (pos == std::string::npos || pos == 0) continue;
+
+        int count = atoi(line.c_str() + pos + 1);
+        if (count > 0) {
+            counts[line.substr(0, pos)] = count;
+        }
+    }
+}
+
+void PlayHistory::save() {
+    // 先写入临时文件再重命名：启动游戏时进程可能被替换或断电，不能留下截断的记录
+    std::string tmpPath = historyPath + ".tmp";
+    std::ofstream file(tmpPath);
+    if (!file.is_open()) {
+        std::cerr << "无法保存启动记录: " << tmpPath << std::endl;
+        return;
+    }
+
+    for (const auto& pair : counts) {
+        file << pair.first << "=" << pair.second << "\n";
+    }
+    file.close();
+
+    if (!file || rename(tmpPath.c_str(), historyPath.c_str()) != 0) {
+        std::cerr << "保存启动记录失败: " << historyPath << std::endl;
+        remove(tmpPath.c_str());
+    }
+}
+
+int PlayHistory::getCount(const std::string& filePath) {
+    if (!loaded) {
+        load();
+    }
+    auto it = counts.find(BannerCache::makeKey(filePath));
+    return it != counts.end() ? it->second : 0;
+}
+
+void PlayHistory::recordLaunch(const std::string& filePath) {
+    if (!loaded) {
+        load();
+    }
+    counts[BannerCache::makeKey(filePath)]++;
+    save();
+}
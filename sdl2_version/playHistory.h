@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <map>
+
+// 游戏启动次数（按游玩次数排序时使用），保存在playcount.ini，每行为 路径=次数
+// 路径使用BannerCache::makeKey规范化，与文件列表中的相对路径对应
+class PlayHistory {
+public:
+    // 获取启动次数（首次调用时加载文件）
+    static int getCount(const std::string& filePath);
+
+    // 记录一次启动并立即保存（启动游戏后进程会被替换）
+    static void recordLaunch(const std::string& filePath);
+
+private:
+    static std::string historyPath;
+    static std::map<std::string, int> counts;
+    static bool loaded;
+
+    static void load();
+    static void save();
+};
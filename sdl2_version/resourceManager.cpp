@@ -1,4 +1,5 @@
 #include "resourceManager.h"
+#include "negativeCache.h"
 #include <iostream>
 #include <fstream>
 #include <algorithm>
@@ -6,10 +7,18 @@
 
 SDL_Renderer* ResourceManager::renderer = nullptr;
 std::string ResourceManager::themeBasePath = "../romsel_dsimenutheme/nitrofiles/themes/3ds/light";
-std::map<std::string, SDL_Texture*> ResourceManager::textureCache;
+std::map<std::string, ResourceManager::CachedTexture> ResourceManager::textureCache;
+std::list<std::string> ResourceManager::lruList;
+CacheStats ResourceManager::stats;
+
+// 默认纹理缓存预算：32MB
+static const size_t DEFAULT_TEXTURE_BUDGET = 32 * 1024 * 1024;
 
 void ResourceManager::init(SDL_Renderer* renderer) {
     ResourceManager::renderer = renderer;
+    if (stats.budgetBytes == 0) {
+        stats.budgetBytes = DEFAULT_TEXTURE_BUDGET;
+    }
     
     // 默认使用Classic DS Menu主题（3ds/light）
     // 尝试多个可能的主题路径，优先使用nitrofiles目录
@@ -47,26 +56,34 @@ void ResourceManager::init(SDL_Renderer* renderer) {
 }
 
 void ResourceManager::cleanup() {
+    std::cout << "纹理缓存统计: 命中 " << stats.hits << ", 未命中 " << stats.misses
+              << ", 淘汰 " << stats.evictions << ", 占用 " << stats.bytesUsed / 1024 << "KB" << std::endl;
     clearCache();
     renderer = nullptr;
 }
 
-SDL_Texture* ResourceManager::loadImage(const std::string& path) {
+SDL_Texture* ResourceManager::loadImage(const std::string& path, bool pinned) {
     if (!renderer) {
         std::cerr << "渲染器未初始化" << std::endl;
         return nullptr;
     }
     
     // 检查缓存
-    SDL_Texture* cached = getCachedTexture(path);
+    SDL_Texture* cached = getCachedTexture(path, pinned);
     if (cached) {
         return cached;
     }
     
+    // 最近加载失败且文件没有变化，不再重复尝试
+    if (NegativeCache::shouldSkip(path)) {
+        return nullptr;
+    }
+    
     // 加载图片
     SDL_Surface* surface = IMG_Load(path.c_str());
     if (!surface) {
         std::cerr << "无法加载图片: " << path << " - " << IMG_GetError() << std::endl;
+        NegativeCache::recordFailure(path);
         return nullptr;
     }
     
@@ -118,11 +135,12 @@ SDL_Texture* ResourceManager::loadImage(const std::string& path) {
     
     if (!texture) {
         std::cerr << "无法创建纹理: " << path << " - " << SDL_GetError() << std::endl;
+        NegativeCache::recordFailure(path);
         return nullptr;
     }
     
     // 缓存纹理
-    cacheTexture(path, texture);
+    cacheTexture(path, texture, pinned);
     
     return texture;
 }
@@ -133,9 +151,10 @@ SDL_Texture* ResourceManager::loadImageFromTheme(const std::string& relativePath
     const char* extensions[] = {".png", ".bmp", ".grf", ""};
     
     // 首先尝试从当前主题路径加载（默认是3ds/light）
+    // 主题资源始终显示在屏幕上，固定在缓存中
     for (int i = 0; extensions[i][0] != '\0'; i++) {
         std::string fullPath = themeBasePath + "/" + relativePath + extensions[i];
-        SDL_Texture* tex = loadImage(fullPath);
+        SDL_Texture* tex = loadImage(fullPath, true);
         if (tex) {
             return tex;
         }
@@ -145,7 +164,7 @@ SDL_Texture* ResourceManager::loadImageFromTheme(const std::string& relativePath
     std::string resourcesPath = "../romsel_dsimenutheme/resources/dsimenu_theme_examples/3ds/light/" + relativePath;
     for (int i = 0; extensions[i][0] != '\0'; i++) {
         std::string fullPath = resourcesPath + extensions[i];
-        SDL_Texture* tex = loadImage(fullPath);
+        SDL_Texture* tex = loadImage(fullPath, true);
         if (tex) {
             return tex;
         }
@@ -155,7 +174,7 @@ SDL_Texture* ResourceManager::loadImageFromTheme(const std::string& relativePath
     std::string gritPath = "../romsel_dsimenutheme/resources/dsimenu_theme_examples/3ds/light/grit/" + relativePath;
     for (int i = 0; extensions[i][0] != '\0'; i++) {
         std::string fullPath = gritPath + extensions[i];
-        SDL_Texture* tex = loadImage(fullPath);
+        SDL_Texture* tex = loadImage(fullPath, true);
         if (tex) {
             return tex;
         }
@@ -171,6 +190,7 @@ std::string ResourceManager::getThemePath() {
 void ResourceManager::setThemePath(const std::string& path) {
     themeBasePath = path;
     clearCache(); // 清除缓存，因为主题改变了
+    NegativeCache::clear();
 }
 
 void ResourceManager::preloadCommonResources() {
@@ -185,22 +205,72 @@ void ResourceManager::preloadCommonResources() {
 
 void ResourceManager::clearCache() {
     for (auto& pair : textureCache) {
-        if (pair.second) {
-            SDL_DestroyTexture(pair.second);
+        if (pair.second.texture) {
+            SDL_DestroyTexture(pair.second.texture);
         }
     }
     textureCache.clear();
+    lruList.clear();
+    stats.bytesUsed = 0;
 }
 
-SDL_Texture* ResourceManager::getCachedTexture(const std::string& key) {
+void ResourceManager::setMemoryBudget(size_t bytes) {
+    stats.budgetBytes = bytes;
+    trim(bytes);
+}
+
+void ResourceManager::trim(size_t targetBytes) {
+    // 从最久未使用的一端淘汰，固定的纹理不在lruList中
+    while (stats.bytesUsed > targetBytes && !lruList.empty()) {
+        auto it = textureCache.find(lruList.back());
+        lruList.pop_back();
+        if (it == textureCache.end()) continue;
+        
+        SDL_DestroyTexture(it->second.texture);
+        stats.bytesUsed -= it->second.bytes;
+        stats.evictions++;
+        textureCache.erase(it);
+    }
+}
+
+SDL_Texture* ResourceManager::getCachedTexture(const std::string& key, bool pin) {
     auto it = textureCache.find(key);
     if (it != textureCache.end()) {
-        return it->second;
+        stats.hits++;
+        CachedTexture& entry = it->second;
+        if (!entry.pinned) {
+            if (pin) {
+                // 改为固定：从LRU列表中移除
+                lruList.erase(entry.lruPos);
+                entry.pinned = true;
+            } else if (entry.lruPos != lruList.begin()) {
+                lruList.splice(lruList.begin(), lruList, entry.lruPos);
+            }
+        }
+        return entry.texture;
     }
+    stats.misses++;
     return nullptr;
 }
 
-void ResourceManager::cacheTexture(const std::string& key, SDL_Texture* texture) {
-    textureCache[key] = texture;
+void ResourceManager::cacheTexture(const std::string& key, SDL_Texture* texture, bool pinned) {
+    // 按RGBA8888估算显存占用
+    int w = 0, h = 0;
+    SDL_QueryTexture(texture, nullptr, nullptr, &w, &h);
+    
+    CachedTexture entry;
+    entry.texture = texture;
+    entry.bytes = (size_t)w * h * 4;
+    entry.pinned = pinned;
+    
+    // 先淘汰旧纹理再插入，保证刚加载的纹理不会被立即淘汰
+    trim(stats.budgetBytes > entry.bytes ? stats.budgetBytes - entry.bytes : 0);
+    
+    if (!pinned) {
+        lruList.push_front(key);
+        entry.lruPos = lruList.begin();
+    }
+    
+    textureCache[key] = entry;
+    stats.bytesUsed += entry.bytes;
 }
-
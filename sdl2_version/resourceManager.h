@@ -4,7 +4,9 @@
 #include <SDL2/SDL_image.h>
 #include <string>
 #include <map>
+#include <list>
 #include <memory>
+#include "cacheStats.h"
 
 // 资源管理器 - 加载和管理Classic DS Menu主题资源
 class ResourceManager {
@@ -12,8 +14,8 @@ public:
     static void init(SDL_Renderer* renderer);
     static void cleanup();
     
-    // 加载图片资源
-    static SDL_Texture* loadImage(const std::string& path);
+    // 加载图片资源（pinned的纹理常驻内存，不会被LRU淘汰）
+    static SDL_Texture* loadImage(const std::string& path, bool pinned = false);
     static SDL_Texture* loadImageFromTheme(const std::string& relativePath);
     
     // 获取主题路径
@@ -26,11 +28,28 @@ public:
     // 缓存管理
     static void clearCache();
     
+    // 内存预算（字节）：超出时淘汰最久未使用的未固定纹理
+    static void setMemoryBudget(size_t bytes);
+    
+    // 淘汰未固定纹理直到占用不超过targetBytes（内存压力时调用）
+    static void trim(size_t targetBytes);
+    
+    static const CacheStats& getStats() { return stats; }
+    
 private:
+    struct CachedTexture {
+        SDL_Texture* texture;
+        size_t bytes;
+        bool pinned;
+        std::list<std::string>::iterator lruPos;  // 仅未固定的纹理有效
+    };
+    
     static SDL_Renderer* renderer;
     static std::string themeBasePath;
-    static std::map<std::string, SDL_Texture*> textureCache;
-    static SDL_Texture* getCachedTexture(const std::string& key);
-    static void cacheTexture(const std::string& key, SDL_Texture* texture);
+    static std::map<std::string, CachedTexture> textureCache;
+    static std::list<std::string> lruList;  // 未固定纹理，最近使用的在前
+    static CacheStats stats;
+    static SDL_Texture* getCachedTexture(const std::string& key, bool pin);
+    static void cacheTexture(const std::string& key, SDL_Texture* texture, bool pinned);
 };
 
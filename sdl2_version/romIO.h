@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// ROM元数据读取方式
+enum RomIOMode {
+    ROMIO_PREAD = 0,   // pread精确读取所需范围（默认）
+    ROMIO_MMAP         // mmap映射文件后复制所需范围
+};
+
+// ROM文件只读访问：只读取文件头和Banner所需的字节范围，
+// 并关闭内核预读，避免在SD卡上为每个ROM多读上百KB
+// 可在工作线程中使用（每个线程使用自己的RomFile）
+class RomFile {
+public:
+    RomFile();
+    ~RomFile();
+
+    bool open(const std::string& filePath);
+    void close();
+
+    uint64_t size() const { return fileSize; }
+
+    // 从offset处读取len字节，不足len字节时返回false
+    bool readAt(uint64_t offset, void* buffer, size_t len);
+
+private:
+    int fd;
+    uint64_t fileSize;
+    const uint8_t* mapped;   // mmap模式下的映射地址
+
+    RomFile(const RomFile&) = delete;
+    RomFile& operator=(const RomFile&) = delete;
+};
+
+// ROM读取的全局设置和统计
+class RomIO {
+public:
+    static void setMode(RomIOMode mode) { RomIO::mode = mode; }
+    static RomIOMode getMode() { return mode; }
+
+    // 开始新的目录扫描（清零统计，并输出上一次扫描的统计）
+    static void beginScan(const std::string& dirPath);
+
+    // 当前扫描打开的文件数和读取的字节数
+    static uint64_t getFilesOpened() { return filesOpened; }
+    static uint64_t getBytesRead() { return bytesRead; }
+
+    // 输出当前扫描的统计
+    static void printScanStats();
+
+private:
+    friend class RomFile;
+
+    static std::atomic<RomIOMode> mode;
+    static std::atomic<uint64_t> filesOpened;
+    static std::atomic<uint64_t> bytesRead;
+    static std::string scanPath;  // 仅主线程访问
+};
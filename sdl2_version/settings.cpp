@@ -38,6 +38,30 @@ void Settings::load() {
             bottomWallpaperPath = value;
         } else if (key == "timeOffsetSeconds") {
             timeOffsetSeconds = std::stoi(value);
+        } else if (key == "iconCacheBudgetKB") {
+            iconCacheBudgetKB = std::stoi(value);
+        } else if (key == "textureCacheBudgetKB") {
+            textureCacheBudgetKB = std::stoi(value);
+        } else if (key == "textCacheBudgetKB") {
+            textCacheBudgetKB = std::stoi(value);
+        } else if (key == "fontBackend") {
+            fontBackend = value;
+        } else if (key == "romIOMode") {
+            romIOMode = value;
+        } else if (key == "libraryRoots") {
+            libraryRoots = value;
+        } else if (key == "sortMode") {
+            sortMode = value;
+        } else if (key == "viewMode") {
+            viewMode = value;
+        } else if (key == "keyRepeatDelayMs") {
+            keyRepeatDelayMs = std::stoi(value);
+        } else if (key == "keyRepeatIntervalMs") {
+            keyRepeatIntervalMs = std::stoi(value);
+        } else if (key == "keyRepeatMinIntervalMs") {
+            keyRepeatMinIntervalMs = std::stoi(value);
+        } else if (key == "keyRepeatAcceleration") {
+            keyRepeatAcceleration = std::stoi(value);
         }
     }
     
@@ -59,6 +83,18 @@ void Settings::save() {
     file << "topWallpaperPath=" << topWallpaperPath << std::endl;
     file << "bottomWallpaperPath=" << bottomWallpaperPath << std::endl;
     file << "timeOffsetSeconds=" << timeOffsetSeconds << std::endl;
+    file << "iconCacheBudgetKB=" << iconCacheBudgetKB << std::endl;
+    file << "textureCacheBudgetKB=" << textureCacheBudgetKB << std::endl;
+    file << "textCacheBudgetKB=" << textCacheBudgetKB << std::endl;
+    file << "fontBackend=" << fontBackend << std::endl;
+    file << "romIOMode=" << romIOMode << std::endl;
+    file << "libraryRoots=" << libraryRoots << std::endl;
+    file << "sortMode=" << sortMode << std::endl;
+    file << "viewMode=" << viewMode << std::endl;
+    file << "keyRepeatDelayMs=" << keyRepeatDelayMs << std::endl;
+    file << "keyRepeatIntervalMs=" << keyRepeatIntervalMs << std::endl;
+    file << "keyRepeatMinIntervalMs=" << keyRepeatMinIntervalMs << std::endl;
+    file << "keyRepeatAcceleration=" << keyRepeatAcceleration << std::endl;
     
     file.close();
 }
@@ -14,8 +14,42 @@ struct Settings {
     // 日期时间设置（相对于系统时间的偏移，单位：秒）
     int timeOffsetSeconds;  // 时间偏移（秒）
     
+    // 缓存内存预算（KB）
+    int iconCacheBudgetKB;     // ROM图标图集
+    int textureCacheBudgetKB;  // 图片纹理缓存
+    int textCacheBudgetKB;     // 整串文本纹理缓存
+    
+    // 字体后端："ttf"（系统TTF字体）或"nftr"（主题自带的DS系统字体）
+    // nftr只使用主题的small.nftr一种字号：所有文字都以这个大小绘制，忽略各处指定的字号
+    std::string fontBackend;
+    
+    // ROM元数据读取方式："pread"或"mmap"
+    std::string romIOMode;
+    
+    // ROM库索引的根目录（以';'分隔）
+    std::string libraryRoots;
+    
+    // 文件列表排序方式："name"、"title"、"size"、"mtime"或"playcount"
+    std::string sortMode;
+    
+    // 下屏文件视图："grid"（DSi图标网格）或"list"（列表，适合大目录）
+    std::string viewMode;
+    
+    // 按键连发：按住keyRepeatDelayMs后开始连发，间隔从keyRepeatIntervalMs开始
+    // 每次乘以keyRepeatAcceleration%，最短keyRepeatMinIntervalMs
+    int keyRepeatDelayMs;
+    int keyRepeatIntervalMs;
+    int keyRepeatMinIntervalMs;
+    int keyRepeatAcceleration;
+    
     Settings() : showFPS(true), fontSize(12), language("zh_CN"), fullscreen(false), scale(3), 
-                 topWallpaperPath(""), bottomWallpaperPath(""), timeOffsetSeconds(0) {}
+                 topWallpaperPath(""), bottomWallpaperPath(""), timeOffsetSeconds(0),
+                 iconCacheBudgetKB(8192), textureCacheBudgetKB(32768), textCacheBudgetKB(1024),
+                 fontBackend("ttf"),
+                 romIOMode("pread"),
+                 libraryRoots("."), sortMode("name"), viewMode("grid"),
+                 keyRepeatDelayMs(300), keyRepeatIntervalMs(100), keyRepeatMinIntervalMs(25),
+                 keyRepeatAcceleration(85) {}
     
     void load();
     void save();
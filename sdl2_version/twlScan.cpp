@@ -0,0 +1,171 @@
+// twl_scan：离线ROM库扫描工具
+// 并行读取目录树中所有ROM的Banner，预先生成UI启动时读取的Banner缓存，
+// 拷贝ROM到存储卡后运行一次，设备首次启动时就不需要再扫描
+#include "bannerCache.h"
+#include "ndsBanner.h"
+#include "fileTypes.h"
+#include "romIO.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <dirent.h>
+#include <sys/stat.h>
+
+static void printUsage(const char* argv0) {
+    std::cout << "用法: " << argv0 << " [选项] <ROM目录>..." << std::endl;
+    std::cout << "  -o <文件>   缓存输出路径（默认 bannercache.bin）" << std::endl;
+    std::cout << "  -j <线程数> 并行线程数（默认使用全部CPU核心）" << std::endl;
+    std::cout << "  -p <路径>   设备上ROM目录的路径（在电脑上扫描挂载的存储卡时，" << std::endl;
+    std::cout << "              缓存键中的扫描目录替换为该路径）" << std::endl;
+    std::cout << "  --mmap      使用mmap读取ROM" << std::endl;
+}
+
+struct ScanFile {
+    std::string path;  // 本机上的路径
+    std::string key;   // 写入缓存时使用的路径（设备上的路径）
+};
+
+// 递归收集ROM文件
+static void collectFiles(const std::string& dirPath, const std::string& keyPath, std::vector<ScanFile>& files) {
+    DIR* dir = opendir(dirPath.c_str());
+    if (!dir) {
+        std::cerr << "无法打开目录: " << dirPath << std::endl;
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') {
+            continue;  // 跳过 . 、 .. 和隐藏文件
+        }
+
+        std::string path = dirPath + "/" + entry->d_name;
+        std::string key = keyPath + "/" + entry->d_name;
+
+        // 部分文件系统不提供d_type，退回stat
+        bool isDirectory = entry->d_type == DT_DIR;
+        bool isRegular = entry->d_type == DT_REG;
+        if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK) {
+            struct stat st;
+            if (stat(path.c_str(), &st) != 0) continue;
+            isDirectory = S_ISDIR(st.st_mode);
+            isRegular = S_ISREG(st.st_mode);
+        }
+
+        if (isDirectory) {
+            collectFiles(path, key, files);
+        } else if (isRegular && classifyFileName(entry->d_name) == FILE_TYPE_NDS) {
+            files.push_back({path, key});
+        }
+    }
+
+    closedir(dir);
+}
+
+int main(int argc, char* argv[]) {
+    std::string outputPath = "bannercache.bin";
+    std::string devicePrefix;
+    int threadCount = (int)std::thread::hardware_concurrency();
+    std::vector<std::string> roots;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threadCount = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            devicePrefix = argv[++i];
+        } else if (strcmp(argv[i], "--mmap") == 0) {
+            RomIO::setMode(ROMIO_MMAP);
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else if (argv[i][0] == '-') {
+            std::cerr << "未知选项: " << argv[i] << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            roots.push_back(argv[i]);
+        }
+    }
+
+    if (roots.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (threadCount < 1) threadCount = 1;
+    if (!devicePrefix.empty() && roots.size() > 1) {
+        std::cerr << "-p 只能用于单个ROM目录" << std::endl;
+        return 1;
+    }
+
+    // 收集文件
+    std::vector<ScanFile> files;
+    for (const auto& root : roots) {
+        collectFiles(root, devicePrefix.empty() ? root : devicePrefix, files);
+    }
+    std::cout << "找到 " << files.size() << " 个ROM，使用 " << threadCount << " 个线程" << std::endl;
+
+    // 载入已有缓存，未变化的ROM直接跳过
+    BannerCache::init(outputPath);
+    RomIO::beginScan(roots[0]);
+
+    std::atomic<size_t> nextIndex(0);
+    std::atomic<size_t> updated(0);
+    std::atomic<size_t> unchanged(0);
+    std::atomic<size_t> failed(0);
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        BannerCacheEntry entry;
+        while (true) {
+            size_t index = nextIndex++;
+            if (index >= files.size()) break;
+            const ScanFile& file = files[index];
+
+            // 缓存键与本机路径相同时才能用文件状态验证旧条目
+            if (file.key == file.path && BannerCache::lookupCopy(file.path, entry)) {
+                unchanged++;
+                continue;
+            }
+
+            if (!BannerCache::buildEntry(file.path, entry)) {
+                std::cerr << "无法读取NDS Banner: " << file.path << std::endl;
+                failed++;
+                continue;
+            }
+            BannerCache::store(file.key, entry);
+            updated++;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    uint64_t bytesRead = RomIO::getBytesRead();
+
+    std::cout << "更新 " << updated << " 个, 未变化 " << unchanged << " 个, 失败 " << failed << " 个" << std::endl;
+    std::cout << "耗时 " << seconds << " 秒, " << (seconds > 0 ? files.size() / seconds : 0) << " 个文件/秒, "
+              << "读取 " << bytesRead / 1024 << "KB (" << (seconds > 0 ? bytesRead / seconds / (1024 * 1024) : 0)
+              << " MB/s)" << std::endl;
+
+    // 删除已不存在的ROM的记录（-p时缓存键是设备上的路径，无法在本机检查）
+    if (!BannerCache::save(devicePrefix.empty())) {
+        std::cerr << "无法写入缓存: " << outputPath << std::endl;
+        return 1;
+    }
+    std::cout << "缓存已写入: " << outputPath << std::endl;
+    return failed > 0 && updated + unchanged == 0 ? 1 : 0;
+}